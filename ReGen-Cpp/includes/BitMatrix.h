@@ -0,0 +1,64 @@
+#ifndef BIT_MATRIX_H
+#define BIT_MATRIX_H
+
+#include <bit>
+#include <cstdint>
+
+//Dense boolean matrix packing each row into 64 bits words so that rows can be combined a whole word (or SIMD register) at a time
+class BitMatrix
+{
+public:
+	using Word = uint64_t;
+	static constexpr size_t WORD_SIZE = 64;
+
+	BitMatrix();
+	BitMatrix(size_t inRowCount, size_t inColumnCount);
+
+	[[nodiscard]] size_t getRowCount() const;
+	[[nodiscard]] size_t getColumnCount() const;
+	[[nodiscard]] size_t getWordsPerRow() const;
+	[[nodiscard]] bool at(size_t inRow, size_t inColumn) const;
+	void set(size_t inRow, size_t inColumn);
+	void reset(size_t inRow, size_t inColumn);
+	[[nodiscard]] const Word* getRow(size_t inRow) const;
+	Word* getRow(size_t inRow);
+	[[nodiscard]] size_t countRow(size_t inRow) const;
+
+	//Keeps existing values, grows storage geometrically so that adding nodes one by one stays amortized
+	void resize(size_t inRowCount, size_t inColumnCount);
+	void clear();
+
+	static void andRows(Word* ioDestination, const Word* inSource, size_t inWordCount);
+	static void andNotRows(Word* ioDestination, const Word* inSource, size_t inWordCount);
+	static void orRows(Word* ioDestination, const Word* inSource, size_t inWordCount);
+	[[nodiscard]] static bool intersects(const Word* inFirstRow, const Word* inSecondRow, size_t inWordCount);
+	[[nodiscard]] static size_t count(const Word* inRow, size_t inWordCount);
+	[[nodiscard]] static bool test(const Word* inRow, size_t inColumn);
+	static void set(Word* ioRow, size_t inColumn);
+	static void reset(Word* ioRow, size_t inColumn);
+	[[nodiscard]] static size_t toWordCount(size_t inColumnCount);
+	//Returns inWordCount * WORD_SIZE when no bit is set from inColumn onward
+	[[nodiscard]] static size_t findNextSetBit(const Word* inRow, size_t inWordCount, size_t inColumn);
+
+	//Calls inFunction(column) for each set bit of the row, in increasing column order
+	template<class Function> static void forEachSetBit(const Word* inRow, size_t inWordCount, Function&& inFunction);
+
+private:
+	size_t rowCount;
+	size_t columnCount;
+	size_t wordsPerRow;
+	std::vector<Word> words;
+};
+
+template<class Function> void BitMatrix::forEachSetBit(const Word* inRow, const size_t inWordCount, Function&& inFunction)
+{
+	for(size_t wordIndex = 0; wordIndex < inWordCount; ++wordIndex)
+	{
+		for(Word word = inRow[wordIndex]; word; word &= word - 1)
+		{
+			inFunction(wordIndex * WORD_SIZE + static_cast<size_t>(std::countr_zero(word)));
+		}
+	}
+}
+
+#endif // BIT_MATRIX_H
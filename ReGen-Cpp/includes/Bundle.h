@@ -0,0 +1,94 @@
+#ifndef BUNDLE_H
+#define BUNDLE_H
+
+#include <cstring>
+#include <string_view>
+#include <type_traits>
+
+#include "Symbol.h"
+
+//Size and last write time of a file, to tell whether it changed since it was read. Both are zero for missing files
+struct FileStamp
+{
+	uint64_t size = 0;
+	int64_t writeTime = 0;
+
+	[[nodiscard]] static FileStamp read(const std::string& inPath);
+	bool operator==(const FileStamp&) const = default;
+};
+
+//Binary cache of the loaded data, so that later runs skip parsing the XML sources and compiling the rules. The file is read through a memory mapping but isn't used in place:
+//symbols are interned again and graphs and rules rebuilt from its records, so loading still grows with the size of the data. A bundle starts with its version and a checksum of the rest, then the sources it was written from, the interned strings and the content written by the data owners
+class BundleWriter
+{
+public:
+	//Incremented whenever the layout of the written data changes, older bundles are then ignored
+	static constexpr uint32_t VERSION = 7;
+
+	template<class T> void write(T inValue);
+	void writeString(std::string_view inString);
+	//Symbols are written as their ids, the whole symbol table is saved with the bundle so that reading it interns the strings in the same order
+	void writeSymbol(Symbol inSymbol);
+	//Written to a temporary file first, so that a bundle is either complete or missing. The stamps are those the sources had when they were read
+	void save(const std::string& inPath, const std::vector<std::pair<std::string, FileStamp> >& inSources) const;
+
+private:
+	std::string content;
+};
+
+class BundleReader
+{
+public:
+	BundleReader() = default;
+	BundleReader(const BundleReader&) = delete;
+	BundleReader& operator=(const BundleReader&) = delete;
+	~BundleReader();
+
+	//Maps the bundle and interns its strings. Fails if there is no bundle, if it was written by another version, if it is corrupt or if one of its sources changed since
+	[[nodiscard]] bool open(const std::string& inPath);
+	//Reads past the end of the bundle or of unknown symbols fail the reader, they then return default values as every later read does
+	template<class T> [[nodiscard]] T read();
+	//Points into the mapped file, valid until the reader is destroyed
+	[[nodiscard]] std::string_view readString();
+	[[nodiscard]] Symbol readSymbol();
+	//Count of the elements that follow, each taking at least inElementSize bytes. Fails the reader if they can't fit in the rest of the bundle,
+	//so that a wrong count can't drive loops or allocations past what the bundle holds
+	[[nodiscard]] uint32_t readCount(size_t inElementSize);
+	//For the checks only the data owners can make, e.g. indexes in range
+	void fail();
+	[[nodiscard]] bool hasFailed() const;
+	[[nodiscard]] bool isAtEnd() const;
+
+private:
+	[[nodiscard]] bool canRead(size_t inSize) const;
+	[[nodiscard]] bool canReadString() const;
+	void close();
+
+	const char* data = nullptr;
+	size_t size = 0;
+	const char* cursor = nullptr;
+	std::vector<Symbol> symbols; //By id in the bundle
+	bool bHasFailed = false;
+};
+
+template<class T> void BundleWriter::write(const T inValue)
+{
+	static_assert(std::is_trivially_copyable_v<T>);
+	content.append(reinterpret_cast<const char*>(&inValue), sizeof(T));
+}
+
+template<class T> T BundleReader::read()
+{
+	static_assert(std::is_trivially_copyable_v<T>);
+	T result{};
+	if(bHasFailed || !canRead(sizeof(T)))
+	{
+		bHasFailed = true;
+		return result;
+	}
+	std::memcpy(&result, cursor, sizeof(T)); //The mapped data isn't aligned
+	cursor += sizeof(T);
+	return result;
+}
+
+#endif // BUNDLE_H
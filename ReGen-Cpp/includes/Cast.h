@@ -0,0 +1,49 @@
+#ifndef CAST_H
+#define CAST_H
+
+#include <array>
+
+#include "Singleton.h"
+#include "Symbol.h"
+
+class Node;
+
+//World nodes playing the roles of a story, by role slot. Roles are numbered once for all the rules when they are loaded,
+//so that a cast is a small array copied by value rather than a map from role names
+class Cast
+{
+public:
+	static constexpr int MAX_ROLE_COUNT = 32;
+
+	Cast();
+
+	[[nodiscard]] bool contains(int inRoleSlot) const;
+	[[nodiscard]] int getNodeIndex(int inRoleSlot) const;
+	[[nodiscard]] const Node* getNode(int inRoleSlot) const;
+	void setNodeIndex(int inRoleSlot, int inNodeIndex);
+
+private:
+	std::array<int, MAX_ROLE_COUNT> nodesIndexes;
+};
+
+//Numbers the roles of the rules, roles with the same name share the same slot in every rule
+class RoleTable final : public Singleton<RoleTable>
+{
+	friend class Singleton<RoleTable>;
+
+public:
+	//The player takes part in every story, even when the rules don't cast it
+	static constexpr int PLAYER_SLOT = 0;
+
+	//Numbers the role the first time it is met, roles are only numbered while the rules are loaded
+	int getSlot(Symbol inRoleName);
+	[[nodiscard]] Symbol getRoleName(int inRoleSlot) const;
+
+private:
+	RoleTable();
+
+	std::unordered_map<Symbol, int> slots;
+	std::vector<Symbol> rolesNames; //By slot
+};
+
+#endif // CAST_H
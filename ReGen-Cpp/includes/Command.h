@@ -3,9 +3,12 @@
 
 #include <any>
 #include <functional>
+#include <variant>
 
+#include "Cast.h"
 #include "Conditions.h"
 
+//Command as read from a modification file, compiled by the registry before being used
 struct CommandData
 {
 	std::string name;
@@ -13,10 +16,54 @@ struct CommandData
 	std::vector<std::any> arguments;
 };
 
+//Argument referring to a node of the cast
+struct RoleArgument
+{
+	int slot;
+};
+
+enum class CommandArgumentType
+{
+	Role,
+	Symbol,
+	Symbols,
+	Attribute
+};
+
+//Alternatives in the order of CommandArgumentType
+using CommandArgument = std::variant<RoleArgument, Symbol, std::vector<Symbol>, NodeAttribute>;
+
+//Command resolved once when its rule is loaded, its arguments are already converted to the types its signature expects
+struct CompiledCommand
+{
+	const struct Command* command;
+	int callerSlot;
+	std::vector<CommandArgument> arguments;
+
+	template<class T> [[nodiscard]] const T& getArgument(size_t inPosition) const;
+};
+
 struct Command
 {
-	std::function<void(const std::unordered_map<std::string, std::shared_ptr<Node> >&, const CommandData&)> implementation;
-	std::function<ConditionsBlock(const std::unordered_map<std::string, std::shared_ptr<Node> >&, const CommandData&)> conditionConstructor;
+	Command(std::vector<CommandArgumentType> inSignature, std::function<void(const Cast&, const CompiledCommand&)> inImplementation, std::function<ConditionsBlock(const Cast&, const CompiledCommand&)> inConditionConstructor);
+
+	std::vector<CommandArgumentType> signature;
+	std::function<void(const Cast&, const CompiledCommand&)> implementation;
+	std::function<ConditionsBlock(const Cast&, const CompiledCommand&)> conditionConstructor;
+	std::string name; //Set by the registry
 };
 
+inline Command::Command(std::vector<CommandArgumentType> inSignature, std::function<void(const Cast&, const CompiledCommand&)> inImplementation, std::function<ConditionsBlock(const Cast&, const CompiledCommand&)> inConditionConstructor) :
+	signature(std::move(inSignature)),
+	implementation(std::move(inImplementation)),
+	conditionConstructor(std::move(inConditionConstructor))
+{
+}
+
+template<class T> const T& CompiledCommand::getArgument(const size_t inPosition) const
+{
+	assert(inPosition < arguments.size());
+	return *std::get_if<T>(&arguments[inPosition]);
+}
+
 #endif // COMMAND_H
@@ -10,8 +10,11 @@ class CommandRegistry final : public Singleton<CommandRegistry>
 
 public:
 	void registerCommand(const std::string& inKey, Command* inObject) const;
-	void executeCommand(const std::unordered_map<std::string, std::shared_ptr<Node> >& inCast, const CommandData& inCommandData) const;
-	[[nodiscard]] ConditionsBlock getCommandConditions(const std::unordered_map<std::string, std::shared_ptr<Node> >& inCast, const CommandData& inCommandData) const;
+	//Resolves the command by its name and converts its arguments to the types of its signature, commands must be registered before the rules using them are loaded
+	[[nodiscard]] CompiledCommand compileCommand(const CommandData& inCommandData) const;
+	[[nodiscard]] const Command* getCommand(const std::string& inName) const;
+	static void executeCommand(const Cast& inCast, const CompiledCommand& inCommand);
+	[[nodiscard]] static ConditionsBlock getCommandConditions(const Cast& inCast, const CompiledCommand& inCommand);
 
 private:
 	Command* find(const std::string& inKey) const;
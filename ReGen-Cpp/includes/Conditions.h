@@ -10,13 +10,16 @@ enum class ComparisonType
 	Lesser = 2
 };
 
+//Conditions refer to world graph nodes, which are identified by their index
 struct NodeCondition
 {
-	std::shared_ptr<Node> node;
-	std::string attributeName;
-	std::string attributeValue;
+	const Node* node;
+	Symbol attributeName;
+	NodeAttribute attributeValue;
 	ComparisonType comparisonType;
 
+	//Conditions on the same attribute of the same node share the same key
+	[[nodiscard]] uint64_t getKey() const;
 	[[nodiscard]] bool conflicts(const NodeCondition& inNodeCondition) const;
 	[[nodiscard]] bool compares(const NodeCondition& inNodeCondition) const;
 
@@ -25,25 +28,55 @@ struct NodeCondition
 #endif
 };
 
-class EdgeCondition : public Edge
+class EdgeCondition
 {
 public:
-	EdgeCondition(const std::shared_ptr<Node>& inSourceNode, const std::shared_ptr<Node>& inTargetNode, const std::unordered_map<std::string, std::string> & inAttributes);
+	EdgeCondition(const Node* inSourceNode, const Node* inTargetNode, EdgeAttributes inAttributes);
 
+	[[nodiscard]] const Node* getSourceNode() const;
+	[[nodiscard]] const Node* getTargetNode() const;
+	[[nodiscard]] const EdgeAttributes& getAttributes() const;
+	//A node may be missing, e.g. the location of a homeless actor. Such conditions are kept but can't be keyed nor conflict with any other
+	[[nodiscard]] bool hasNodes() const;
+	//Conditions between the same source and target nodes share the same key, only for conditions with both nodes
+	[[nodiscard]] uint64_t getKey() const;
 	[[nodiscard]] bool conflicts(const EdgeCondition& inEdgeCondition) const;
+
+#ifndef NDEBUG
+	void print() const;
+#endif
+
+private:
+	const Node* sourceNode;
+	const Node* targetNode;
+	EdgeAttributes attributes;
 };
 
-struct Conditions
+//Conditions indexed by key, so that conflicts are found by probing the index with each condition rather than by comparing every pair of conditions
+class Conditions
 {
-	std::list<NodeCondition> nodeConditions;
-	std::list<EdgeCondition> edgeConditions;
+public:
+	Conditions() = default;
+	Conditions(std::initializer_list<NodeCondition> inNodeConditions, std::initializer_list<EdgeCondition> inEdgeConditions);
 
-	[[nodiscard]] bool conflicts(const Conditions& inCondition);
+	[[nodiscard]] const std::vector<NodeCondition>& getNodeConditions() const;
+	[[nodiscard]] const std::vector<EdgeCondition>& getEdgeConditions() const;
+	void addNodeCondition(const NodeCondition& inNodeCondition);
+	void addEdgeCondition(EdgeCondition inEdgeCondition);
+	//Whether one of these conditions conflicts with one of inConditions
+	[[nodiscard]] bool conflicts(const Conditions& inConditions) const;
+	//Moves the conditions of inConditions at the end of these ones
 	void append(Conditions& inConditions);
 
 #ifndef NDEBUG
 	void print() const;
 #endif
+
+private:
+	std::vector<NodeCondition> nodeConditions;
+	std::vector<EdgeCondition> edgeConditions;
+	std::unordered_map<uint64_t, std::vector<int> > nodeConditionsByKey; //Positions of the node conditions sharing a key
+	std::unordered_map<uint64_t, std::vector<int> > edgeConditionsByKey; //Conditions missing a node aren't indexed
 };
 
 struct ConditionsBlock
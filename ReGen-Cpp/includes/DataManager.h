@@ -1,7 +1,9 @@
 #ifndef DATAMANAGER_H
 #define DATAMANAGER_H
 
+#include "Bundle.h"
 #include "Graph.h"
+#include "GraphSnapshot.h"
 #include "Rule.h"
 #include "Singleton.h"
 #include "TestLayout.h"
@@ -11,7 +13,17 @@ class DataManager final : public Singleton<DataManager>
 	friend class Singleton<DataManager>;
 
 public:
-	void init(const char* inTestLayoutName, const char* inContentPath = "./Data/");
+	//Loads from the bundle of the layout in the cache when it is up to date, from the XML sources otherwise, in which case the bundle is written again.
+	//Either way the data ends in the same structures, the bundle only saves parsing the sources and compiling the rules
+	//False if the world graph can't be read, which is reported on the error output
+	[[nodiscard]] bool init(const char* inTestLayoutName, const char* inContentPath = "./Data/");
+	//Loads again what was read from files that changed since: everything if the layout changed, otherwise only the world graph and the changed rules,
+	//the other rules and their cached mappings stay as they are. Must not be called while stories are generated or written, main only polls it between batches
+	//when the layout watches its sources. Returns whether anything was loaded again.
+	//A changed world graph that can't be read is reported and the previous one kept, unless the layout changed too in which case the world is left empty and false is returned
+	bool reload();
+	void loadMatchCache() const;
+	void saveMatchCache() const;
 #ifndef NDEBUG
 	void printTestLayout() const;
 	void printStoryModifications();
@@ -20,17 +32,64 @@ public:
 
 	[[nodiscard]] const TestLayout& getTestLayout() const;
 	[[nodiscard]] const Graph& getWorldGraph() const;
+	//Frozen form of the world graph, taken once it is loaded
+	[[nodiscard]] const GraphSnapshot& getWorldSnapshot() const;
 	[[nodiscard]] const std::list<Rule>& getInitializationRules() const;
 	[[nodiscard]] const std::list<Rule>& getRewriteRules() const;
 	
 private:
+	struct ParsedRuleFiles;
+
+	//Files a part of the data was read from, with their stamps when they were read
+	struct Sources
+	{
+		std::vector<std::pair<std::string, FileStamp> > files;
+
+		void add(const std::string& inPath);
+		[[nodiscard]] bool haveChanged() const;
+		void loadFromBundle(BundleReader& ioReader);
+		void saveToBundle(BundleWriter& ioWriter) const;
+	};
+
+	//Reads the layout, the world graph and the rules from their XML files, noting every file read. False if the world graph can't be read, the rest is still loaded
+	bool loadSources();
+	//The world graph is only replaced if the file is read whole
+	bool loadWorldGraph(const std::string& inPath);
+	//Seed given by the layout, or a random one if it doesn't give any
+	void chooseSeed();
+	void compileMatchPlans(const std::vector<Rule*>& inRules);
+	[[nodiscard]] std::vector<Rule*> getRules();
+	//Drops the compiled modifications that none of the loaded rules uses anymore, once rules have been reloaded
+	void forgetUnusedModifications();
+	//Drops the layout, the world graph and the rules, with the files they were read from
+	void clearData();
+	//Nothing is loaded if there is no bundle, if it is outdated or if it can't be read whole
+	bool loadBundle(const std::string& inPath);
+	void saveBundle(const std::string& inPath) const;
+	static void writeCommands(BundleWriter& ioWriter, const std::vector<CompiledCommand>& inCommands);
+	static std::vector<CompiledCommand> readCommands(BundleReader& ioReader);
+	static void assignRolesSlots(Rule& ioRule);
 	static void readArguments(pugi::xml_node inParsedArguments, std::vector<std::any>& outArguments);
-	void loadRules(const std::string& inRulesPath, const pugi::xml_node& inRulesListingNode, std::list<Rule>& outRulesList) const;
+	//Reads every file of the rule once, can run concurrently with the reading of other rules
+	static std::unique_ptr<ParsedRuleFiles> parseRuleFiles(const std::string& inRuleFolderPath, const std::string& inRuleName);
+	//Modifications with the same content are compiled once and shared
+	std::shared_ptr<const std::vector<CompiledCommand> > loadModification(const std::string& inContent);
+	void loadRules(const std::string& inRulesPath, const pugi::xml_node& inRulesListingNode, std::list<Rule>& outRulesList);
+	void buildRule(std::string inRuleName, ParsedRuleFiles& ioFiles, const std::shared_ptr<const std::vector<CompiledCommand> >& inNoModification, Rule& outRule);
 	
+	std::string contentPath;
+	std::string testLayoutName;
+	std::string matchCachePath;
+	std::string bundlePath;
+	Sources testLayoutSources;
+	Sources worldGraphSources;
+	std::unordered_map<const Rule*, Sources> rulesSources;
 	TestLayout testLayout;	
+	std::optional<uint64_t> layoutSeed; //Empty if the layout doesn't give one, a random seed is then drawn on each run
 	Graph worldGraph;
 	std::list<Rule> initializationRules;
 	std::list<Rule> rewriteRules;
+	std::unordered_map<std::string, std::shared_ptr<const std::vector<CompiledCommand> > > modificationsByContent; //Compiled commands of the modification files, by file content
 };
 
 #endif // DATAMANAGER_H
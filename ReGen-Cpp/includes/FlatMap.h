@@ -0,0 +1,210 @@
+#ifndef FLAT_MAP_H
+#define FLAT_MAP_H
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <initializer_list>
+#include <stdexcept>
+
+//Map storing its entries contiguously, sorted by key. Up to INLINE_CAPACITY entries are stored in the map itself without any allocation,
+//so that small maps can be scanned without chasing pointers
+template<class Key, class Value, size_t INLINE_CAPACITY = 0> class FlatMap
+{
+public:
+	using value_type = std::pair<Key, Value>;
+	using iterator = value_type*;
+	using const_iterator = const value_type*;
+
+	FlatMap() = default;
+	FlatMap(std::initializer_list<value_type> inEntries);
+
+	[[nodiscard]] iterator begin();
+	[[nodiscard]] iterator end();
+	[[nodiscard]] const_iterator begin() const;
+	[[nodiscard]] const_iterator end() const;
+	[[nodiscard]] size_t size() const;
+	[[nodiscard]] bool empty() const;
+	[[nodiscard]] iterator find(const Key& inKey);
+	[[nodiscard]] const_iterator find(const Key& inKey) const;
+	[[nodiscard]] bool contains(const Key& inKey) const;
+	[[nodiscard]] Value& at(const Key& inKey);
+	[[nodiscard]] const Value& at(const Key& inKey) const;
+	Value& operator[](const Key& inKey);
+	//Keeps the current value if the key is already there
+	std::pair<iterator, bool> insert(const value_type& inEntry);
+	//Returns the number of erased entries
+	size_t erase(const Key& inKey);
+	void reserve(size_t inCapacity);
+	void clear();
+
+private:
+	[[nodiscard]] iterator lowerBound(const Key& inKey);
+	[[nodiscard]] const_iterator lowerBound(const Key& inKey) const;
+	iterator insertAt(iterator inPosition, const value_type& inEntry);
+
+	std::array<value_type, INLINE_CAPACITY> inlineEntries{};
+	uint32_t inlineCount = 0;
+	std::vector<value_type> heapEntries; //Every entry once they don't fit inline anymore, inline entries are unused from then on
+};
+
+template<class Key, class Value, size_t INLINE_CAPACITY> FlatMap<Key, Value, INLINE_CAPACITY>::FlatMap(const std::initializer_list<value_type> inEntries)
+{
+	reserve(inEntries.size());
+	for(const auto& entry : inEntries)
+	{
+		insert(entry);
+	}
+}
+
+template<class Key, class Value, size_t INLINE_CAPACITY> typename FlatMap<Key, Value, INLINE_CAPACITY>::iterator FlatMap<Key, Value, INLINE_CAPACITY>::begin()
+{
+	return heapEntries.empty() ? inlineEntries.data() : heapEntries.data();
+}
+
+template<class Key, class Value, size_t INLINE_CAPACITY> typename FlatMap<Key, Value, INLINE_CAPACITY>::iterator FlatMap<Key, Value, INLINE_CAPACITY>::end()
+{
+	return begin() + size();
+}
+
+template<class Key, class Value, size_t INLINE_CAPACITY> typename FlatMap<Key, Value, INLINE_CAPACITY>::const_iterator FlatMap<Key, Value, INLINE_CAPACITY>::begin() const
+{
+	return heapEntries.empty() ? inlineEntries.data() : heapEntries.data();
+}
+
+template<class Key, class Value, size_t INLINE_CAPACITY> typename FlatMap<Key, Value, INLINE_CAPACITY>::const_iterator FlatMap<Key, Value, INLINE_CAPACITY>::end() const
+{
+	return begin() + size();
+}
+
+template<class Key, class Value, size_t INLINE_CAPACITY> size_t FlatMap<Key, Value, INLINE_CAPACITY>::size() const
+{
+	return heapEntries.empty() ? inlineCount : heapEntries.size();
+}
+
+template<class Key, class Value, size_t INLINE_CAPACITY> bool FlatMap<Key, Value, INLINE_CAPACITY>::empty() const
+{
+	return !size();
+}
+
+template<class Key, class Value, size_t INLINE_CAPACITY> typename FlatMap<Key, Value, INLINE_CAPACITY>::iterator FlatMap<Key, Value, INLINE_CAPACITY>::find(const Key& inKey)
+{
+	const auto entry = lowerBound(inKey);
+	return entry != end() && entry->first == inKey ? entry : end();
+}
+
+template<class Key, class Value, size_t INLINE_CAPACITY> typename FlatMap<Key, Value, INLINE_CAPACITY>::const_iterator FlatMap<Key, Value, INLINE_CAPACITY>::find(const Key& inKey) const
+{
+	const auto entry = lowerBound(inKey);
+	return entry != end() && entry->first == inKey ? entry : end();
+}
+
+template<class Key, class Value, size_t INLINE_CAPACITY> bool FlatMap<Key, Value, INLINE_CAPACITY>::contains(const Key& inKey) const
+{
+	return find(inKey) != end();
+}
+
+template<class Key, class Value, size_t INLINE_CAPACITY> Value& FlatMap<Key, Value, INLINE_CAPACITY>::at(const Key& inKey)
+{
+	const auto entry = find(inKey);
+	if(entry == end())
+	{
+		throw std::out_of_range("FlatMap::at");
+	}
+	return entry->second;
+}
+
+template<class Key, class Value, size_t INLINE_CAPACITY> const Value& FlatMap<Key, Value, INLINE_CAPACITY>::at(const Key& inKey) const
+{
+	const auto entry = find(inKey);
+	if(entry == end())
+	{
+		throw std::out_of_range("FlatMap::at");
+	}
+	return entry->second;
+}
+
+template<class Key, class Value, size_t INLINE_CAPACITY> Value& FlatMap<Key, Value, INLINE_CAPACITY>::operator[](const Key& inKey)
+{
+	return insert({inKey, Value()}).first->second;
+}
+
+template<class Key, class Value, size_t INLINE_CAPACITY> std::pair<typename FlatMap<Key, Value, INLINE_CAPACITY>::iterator, bool> FlatMap<Key, Value, INLINE_CAPACITY>::insert(const value_type& inEntry)
+{
+	const auto position = lowerBound(inEntry.first);
+	if(position != end() && position->first == inEntry.first)
+	{
+		return {position, false};
+	}
+	return {insertAt(position, inEntry), true};
+}
+
+template<class Key, class Value, size_t INLINE_CAPACITY> size_t FlatMap<Key, Value, INLINE_CAPACITY>::erase(const Key& inKey)
+{
+	const auto entry = find(inKey);
+	if(entry == end())
+	{
+		return 0;
+	}
+	if(!heapEntries.empty())
+	{
+		heapEntries.erase(heapEntries.begin() + (entry - begin()));
+	}
+	else
+	{
+		std::move(entry + 1, end(), entry);
+		--inlineCount;
+	}
+	return 1;
+}
+
+template<class Key, class Value, size_t INLINE_CAPACITY> void FlatMap<Key, Value, INLINE_CAPACITY>::reserve(const size_t inCapacity)
+{
+	if(inCapacity > INLINE_CAPACITY)
+	{
+		heapEntries.reserve(inCapacity);
+	}
+}
+
+template<class Key, class Value, size_t INLINE_CAPACITY> void FlatMap<Key, Value, INLINE_CAPACITY>::clear()
+{
+	inlineCount = 0;
+	heapEntries.clear();
+}
+
+template<class Key, class Value, size_t INLINE_CAPACITY> typename FlatMap<Key, Value, INLINE_CAPACITY>::iterator FlatMap<Key, Value, INLINE_CAPACITY>::lowerBound(const Key& inKey)
+{
+	return std::lower_bound(begin(), end(), inKey, [](const value_type& inEntry, const Key& inSearchedKey){ return inEntry.first < inSearchedKey; });
+}
+
+template<class Key, class Value, size_t INLINE_CAPACITY> typename FlatMap<Key, Value, INLINE_CAPACITY>::const_iterator FlatMap<Key, Value, INLINE_CAPACITY>::lowerBound(const Key& inKey) const
+{
+	return std::lower_bound(begin(), end(), inKey, [](const value_type& inEntry, const Key& inSearchedKey){ return inEntry.first < inSearchedKey; });
+}
+
+template<class Key, class Value, size_t INLINE_CAPACITY> typename FlatMap<Key, Value, INLINE_CAPACITY>::iterator FlatMap<Key, Value, INLINE_CAPACITY>::insertAt(const iterator inPosition, const value_type& inEntry)
+{
+	const auto offset = inPosition - begin();
+	if(!heapEntries.empty())
+	{
+		return &*heapEntries.insert(heapEntries.begin() + offset, inEntry);
+	}
+
+	if(inlineCount < INLINE_CAPACITY)
+	{
+		std::move_backward(inPosition, end(), end() + 1);
+		*inPosition = inEntry;
+		++inlineCount;
+		return inPosition;
+	}
+
+	//Spills to the heap, the new entry is inserted while moving the inline ones
+	heapEntries.reserve(std::max<size_t>(heapEntries.capacity(), inlineCount + 1));
+	heapEntries.insert(heapEntries.end(), inlineEntries.begin(), inlineEntries.begin() + offset);
+	heapEntries.emplace_back(inEntry);
+	heapEntries.insert(heapEntries.end(), inlineEntries.begin() + offset, inlineEntries.begin() + inlineCount);
+	inlineCount = 0;
+	return heapEntries.data() + offset;
+}
+
+#endif // FLAT_MAP_H
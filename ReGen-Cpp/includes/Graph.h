@@ -2,7 +2,14 @@
 #ifndef GRAPH_H
 #define GRAPH_H
 
-#include <armadillo>
+#include <compare>
+#include <optional>
+#include <random>
+
+#include "BitMatrix.h"
+#include "FlatMap.h"
+#include "Pool.h"
+#include "Symbol.h"
 
 namespace pugi
 {
@@ -11,13 +18,55 @@ namespace pugi
 
 constexpr int NONE = -1;
 
-struct NodeAttribute
+//Attribute value parsed once according to the type given by the data, so that comparisons run on native values rather than on their texts.
+//The text is kept interned alongside, values are indexed and printed through it
+class NodeAttribute
 {
-	std::string type;
-	std::string value;
+public:
+	enum class Type : uint8_t
+	{
+		String,
+		Bool,
+		Int,
+		Float
+	};
+
+	NodeAttribute();
+	//inTypeName is the type as written in the data ("str", "bool", "int" or "float"), values of unknown types or that don't parse are kept as strings
+	NodeAttribute(Symbol inTypeName, Symbol inText);
+
+	[[nodiscard]] Type getType() const;
+	[[nodiscard]] Symbol getTypeName() const;
+	[[nodiscard]] Symbol getText() const;
+	[[nodiscard]] bool getBool() const;
+	[[nodiscard]] int64_t getInt() const;
+	[[nodiscard]] double getFloat() const;
+
+	//Strings are equal when their symbols are, numbers compare by value whether they are ints or floats
+	bool operator==(const NodeAttribute& inNodeAttribute) const;
+	//Only numbers and booleans are ordered, any other pair of values is unordered
+	std::partial_ordering operator<=>(const NodeAttribute& inNodeAttribute) const;
+
+private:
+	[[nodiscard]] bool isNumber() const;
+	[[nodiscard]] double toFloat() const;
+
+	Symbol text;
+	Type type;
+	union
+	{
+		bool boolValue;
+		int64_t intValue;
+		double floatValue;
+	};
 };
 
-class Edge;
+using NodeAttributes = FlatMap<Symbol, NodeAttribute>;
+using EdgeAttributes = FlatMap<Symbol, Symbol, 1>; //Edges almost always hold a single relation
+
+class BundleReader;
+class BundleWriter;
+class GraphSnapshot;
 struct ConditionsBlock;
 
 class Node
@@ -25,36 +74,33 @@ class Node
 friend class Graph;
 public:
 	Node();
-	Node(std::string inName, std::unordered_map<std::string, NodeAttribute> inAttributes);
+	Node(Symbol inName, NodeAttributes inAttributes);
 	
 	[[nodiscard]] const std::string& getName() const;
-	void setName(const std::string& inName);
-	[[nodiscard]] const std::unordered_map<std::string, NodeAttribute>& getAttributes() const;
-	[[nodiscard]] const NodeAttribute& getAttribute(const std::string& inAttributeName) const;
-	void setAttribute(const std::string& inAttributeName, const NodeAttribute& inAttributeValue);
+	[[nodiscard]] Symbol getNameSymbol() const;
+	void setName(Symbol inName);
+	[[nodiscard]] const NodeAttributes& getAttributes() const;
+	[[nodiscard]] const NodeAttribute& getAttribute(Symbol inAttributeName) const;
+	void setAttribute(Symbol inAttributeName, const NodeAttribute& inAttributeValue);
 	[[nodiscard]] std::shared_ptr<ConditionsBlock> getConditionsBlock() const;
 	void setConditionsBlock(ConditionsBlock& inConditionsBlock) const;
-[[nodiscard]] const std::list<std::shared_ptr<Edge>>& getIncomingEdges() const;
-	[[nodiscard]] const std::list<std::shared_ptr<Edge>>& getOutgoingEdges() const;
+	//Handles of the edges in the graph owning the node
+	[[nodiscard]] const std::vector<int>& getIncomingEdges() const;
+	[[nodiscard]] const std::vector<int>& getOutgoingEdges() const;
 	[[nodiscard]] int getIndex() const;
 	[[nodiscard]] bool isValid() const;
 
-	void clearEdges();
-	std::shared_ptr<Node> getSourceNodeFromIncomingEdgeWithAttribute(const std::pair<std::string, std::string>& inAttribute);
-	std::shared_ptr<Node> getTargetNodeFromOutgoingEdgeWithAttribute(const std::pair<std::string, std::string>& inAttribute);
-	bool isSubNode(const Node& inParentNode);
-	bool containsAttributes(const Node& inParentNode);
-	static bool containsEdges(const std::list<std::shared_ptr<Edge> >& inNodeEdges, const std::list<std::shared_ptr<Edge> >& inParentNodeEdges);
-	void validateNode(struct Conditions preConditions, bool inValid);
+	//Attribute values match by text, as the attribute indexes of the graph are keyed, so that anchored searches find the same mappings as full ones
+	[[nodiscard]] bool containsAttributes(const Node& inParentNode) const;
 
 private:	
-	std::string name;
-	std::unordered_map<std::string, NodeAttribute> attributes;
+	Symbol name;
+	NodeAttributes attributes;
 	mutable std::shared_ptr<ConditionsBlock> conditionsBlock; //TODO complex template dev to prevent non-story graphs from having conditions
 	bool bIsValid; //TODO complex template dev to prevent non-story graphs from having validation
 
-	std::list<std::shared_ptr<Edge>> incomingEdges;
-	std::list<std::shared_ptr<Edge>> outgoingEdges;
+	std::vector<int> incomingEdges;
+	std::vector<int> outgoingEdges;
 	int index;
 };
 
@@ -63,64 +109,186 @@ class Edge
 	friend class Graph;
 
 public:
-	Edge() = default;
-	Edge(std::shared_ptr<Node> inSourceNode, std::shared_ptr<Node> inTargetNode, std::unordered_map<std::string, std::string> inAttributes);
+	Edge();
+	Edge(int inSourceIndex, int inTargetIndex, EdgeAttributes inAttributes);
 
-	[[nodiscard]] std::shared_ptr<Node> getSourceNode() const;
-	[[nodiscard]] std::shared_ptr<Node> getTargetNode() const;
-	[[nodiscard]] const std::unordered_map<std::string, std::string>& getAttributes() const;
-
-#ifndef NDEBUG
-	void print() const;
-#endif
+	[[nodiscard]] int getSourceIndex() const;
+	[[nodiscard]] int getTargetIndex() const;
+	[[nodiscard]] const EdgeAttributes& getAttributes() const;
+	//Whether the edge holds at least one of the attributes of the parent edge
+	[[nodiscard]] bool containsAttribute(const Edge& inParentEdge) const;
 
 private:
-	std::shared_ptr<Node> sourceNode;
-	std::shared_ptr<Node> targetNode;
-	std::unordered_map<std::string, std::string> attributes;
+	int sourceIndex;
+	int targetIndex;
+	EdgeAttributes attributes;
+};
+
+enum class GraphOperationType
+{
+	AddNode,
+	RemoveNode,
+	AddEdge,
+	RemoveEdge,
+	SetNodeAttribute
+};
+
+//Journal entry of a modification, so that results computed on the graph can be brought up to date from what changed
+struct GraphOperation
+{
+	GraphOperationType type;
+	int sourceIndex;
+	int targetIndex; //NONE for node operations
+};
+
+//Modification made during a transaction, with what is needed to revert it
+struct GraphUndoRecord
+{
+	enum class Type
+	{
+		AddNode,
+		RemoveNode,
+		SetNodeAttribute,
+		SetNodeValidity,
+		AddEdge,
+		RemoveEdge
+	};
+
+	GraphUndoRecord(Type inType, int inSourceIndex, int inTargetIndex = NONE, int inEdgeHandle = NONE);
+
+	Type type;
+	int sourceIndex; //Modified node, or source node of the edge
+	int targetIndex;
+	int edgeHandle;
+	Node removedNode; //Without its edges, they are removed and recorded beforehand
+	Edge removedEdge;
+	size_t outgoingEdgePosition = 0; //Position of the removed edge in the outgoing edges of its source node
+	size_t incomingEdgePosition = 0;
+	Symbol attributeName;
+	std::optional<NodeAttribute> previousAttribute; //Empty if the node didn't hold the attribute
+	bool bCreatedEdge = false;
+	bool bInsertedEdgeAttribute = false;
+	bool bWasValid = true;
+};
+
+//Order in which the nodes of a searched graph are mapped, most selective first, with the edges toward already mapped nodes to check at each step
+struct MatchPlan
+{
+	struct EdgeCheck
+	{
+		int step; //Step whose mapped node is the other end of the edge
+		bool bIsOutgoing; //The edge goes from the node mapped at the current step to the node mapped at this step
+		int edge; //Handle of the edge in the searched graph
+	};
+
+	std::vector<int> nodesIndexes; //Searched node mapped at each step
+	std::vector<std::vector<EdgeCheck> > edgeChecks; //For each step, edges toward the nodes mapped at previous steps
+	int searchedGraphVersion = NONE;
 };
 
 class Graph
 {
+friend class SubGraphMatcher;
   public:
 	Graph();
     Graph(std::string inName, std::string inType);
 
 	[[nodiscard]] const std::string& getName() const;
 	[[nodiscard]] const std::string& getType() const;
-	[[nodiscard]] std::shared_ptr<Node> getNodeByName(const std::string& inName) const;
-	[[nodiscard]] std::shared_ptr<Node> getNodeByIndex(int inIndex) const;
-	[[nodiscard]] const std::unordered_map<std::string, std::shared_ptr<Node>>& getNodesByName() const;
-	[[nodiscard]] const std::map<int, std::shared_ptr<Node>>& getNodesByIndex() const;
-	[[nodiscard]] const std::map<std::pair<std::string, std::string>, std::shared_ptr<Edge>>& getEdgesByNodesNames() const;
-	[[nodiscard]] const std::map<std::pair<int, int>, std::shared_ptr<Edge>>& getEdgesByNodesIndex() const;
+	[[nodiscard]] Node* getNodeByName(Symbol inName);
+	[[nodiscard]] const Node* getNodeByName(Symbol inName) const;
+	//Null if the node was removed
+	[[nodiscard]] Node* getNodeByIndex(int inIndex);
+	[[nodiscard]] const Node* getNodeByIndex(int inIndex) const;
+	[[nodiscard]] const Edge& getEdge(int inEdgeHandle) const;
+	[[nodiscard]] const std::unordered_map<Symbol, int>& getNodesByName() const;
+	[[nodiscard]] const std::map<std::pair<Symbol, Symbol>, int>& getEdgesByNodesNames() const;
+	[[nodiscard]] const std::map<std::pair<int, int>, int>& getEdgesByNodesIndex() const;
+	//Every node index is lower than this count, removed nodes included
 	[[nodiscard]] int getNodeCount() const;
 	[[nodiscard]] int getEdgeCount() const;
+	//Incremented by every modification, so that results computed on the graph can be tied to its state
+	[[nodiscard]] int getVersion() const;
+	//Hash of nodes, attributes and edges, stable across runs to key persisted results
+	[[nodiscard]] uint64_t computeContentHash() const;
+	//Modifications applied since the graph was loaded, in order
+	[[nodiscard]] const std::vector<GraphOperation>& getOperations() const;
+	//Snapshot taken by createSnapshot, null if there is none or if the graph was modified since
+	[[nodiscard]] const GraphSnapshot* getSnapshot() const;
+	//Plan compiled by compileMatchPlan, null if there is none or if the graph was modified since
+	[[nodiscard]] const MatchPlan* getMatchPlan() const;
+	//Selectivity is estimated from the attribute posting lists and degrees of inStatisticsGraph, or from the graph's own structure when none is given.
+	//A valid inFirstNodeIndex forces that node to be mapped first
+	[[nodiscard]] MatchPlan createMatchPlan(const Graph* inStatisticsGraph = nullptr, int inFirstNodeIndex = NONE) const;
+	[[nodiscard]] const std::vector<int>& getNodesIndexesWithAttribute(Symbol inAttributeName) const;
+	[[nodiscard]] const std::vector<int>& getNodesIndexesWithAttribute(Symbol inAttributeName, Symbol inAttributeValue) const;
 	
 	void loadFromXml(const pugi::xml_node& inParsedXml);
-	void loadFromXml(const std::string& inPath);
-	std::shared_ptr<Node> addNode(Node* inNode);
-	void removeNode(std::shared_ptr<Node> inNodeToRemove) const;
-	void addEdge(std::pair<std::string, std::string> inEdgeAttribute, std::shared_ptr<Node> inSourceNode, std::shared_ptr<Node> inTargetNode);
-	void addEdge(std::pair<std::string, std::string>&& inEdgeAttribute, int inSourceIndex, int inTargetIndex);
-    void addEdge(std::pair<std::string, std::string>&& inEdgeAttribute, const std::string& inSourceNodeName, const std::string& inTargetNodeName);
-	void removeEdge(const std::shared_ptr<Edge> inEdge);
+	//Streams the file element by element instead of parsing it into a document, for large worlds.
+	//A file that can't be opened or is malformed is reported on the error output and false is returned, the graph then holds only part of it and is to be discarded
+	[[nodiscard]] bool loadFromXml(const std::string& inPath);
+	//Nodes and edges are read back in the order they were created, so that the graph gets the same indexes and handles as the one written
+	void loadFromBundle(BundleReader& ioReader);
+	//Only for graphs that were never modified since they were loaded, whose nodes and edges have no freed index
+	void saveToBundle(BundleWriter& ioWriter) const;
+	//Freezes the current state of the graph into a compact read-only form, for graphs that aren't modified anymore
+	void createSnapshot();
+	//Plans the matching of this graph as a searched graph, to be used by every later search while it isn't modified
+	void compileMatchPlan(const Graph* inStatisticsGraph = nullptr);
+	//The node is copied without its edges, they belong to the graph it comes from
+	Node& addNode(Node inNode);
+	//Also removes the edges left on the node, its index can be reused by the next added node
+	void removeNode(int inNodeIndex);
+	void setNodeAttribute(Node& ioNode, Symbol inAttributeName, const NodeAttribute& inAttributeValue);
+	void addEdge(std::pair<Symbol, Symbol> inEdgeAttribute, int inSourceIndex, int inTargetIndex);
+    void addEdge(std::pair<Symbol, Symbol> inEdgeAttribute, Symbol inSourceNodeName, Symbol inTargetNodeName);
 	void removeEdge(int inSourceIndex, int inTargetIndex);
-	void removeEdge(const std::string& inSourceNodeName, const std::string& inTargetNodeName);
-    void saveAsDotFile(const std::string& inColor = "ivory4", const std::string& inFontColor = "ivory4", const std::string& inOutputPath = "./Output", bool inLogAdjacencyMatrix = false) const;
-	void getIsomorphicSubGraphs(const Graph& inSearchedGraph, std::list<std::list<std::shared_ptr<Node>>>& outFoundSubNodes) const;
+	void removeEdge(Symbol inSourceNodeName, Symbol inTargetNodeName);
+	//Writes the graph in DOT format and returns the path of the written file, rendering it is left to the OutputPipeline
+    std::string saveAsDotFile(const std::string& inColor = "ivory4", const std::string& inFontColor = "ivory4", const std::string& inOutputPath = "./Output", bool inLogAdjacencyMatrix = false) const;
+	void getIsomorphicSubGraphs(const Graph& inSearchedGraph, std::list<std::list<const Node*>>& outFoundSubNodes, int inMaxCount = NONE) const;
+	[[nodiscard]] bool hasIsomorphicSubGraph(const Graph& inSearchedGraph) const;
+	void getRandomIsomorphicSubGraphs(const Graph& inSearchedGraph, int inCount, std::default_random_engine& inRandomEngine, std::list<std::list<const Node*>>& outFoundSubNodes) const;
+	//Whether each parent edge, in order, finds a distinct edge holding one of its attributes
+	[[nodiscard]] bool containsEdges(const std::vector<int>& inEdges, const Graph& inParentGraph, const std::vector<int>& inParentEdges) const;
+	//Invalidates the nodes upstream of inNodeIndex whose postconditions conflict with the preconditions of a node between them and inNodeIndex (inNodeIndex included),
+	//as well as the nodes upstream of an invalid one. Done in a single pass in reverse topological order over the u nodes upstream of inNodeIndex and their e edges,
+	//preconditions being merged at join points as bitsets over the p nodes holding some: O(u * p / 64) memory and O(e * p / 64) time besides the conflict probes,
+	//linear while p stays within a few words but quadratic in the worst case
+	void validateNode(int inNodeIndex);
+	//Modifications made until commitTransaction or rollbackTransaction are recorded so that they can be reverted in one go. Transactions don't nest
+	void beginTransaction();
+	void commitTransaction();
+	//Reverts every modification made since beginTransaction in reverse order, the operations journal is truncated back as if they never happened
+	void rollbackTransaction();
+	[[nodiscard]] bool isInTransaction() const;
 
 
 private:	
+	void indexNodeAttribute(int inNodeIndex, Symbol inAttributeName, Symbol inAttributeValue);
+	void unindexNodeAttribute(int inNodeIndex, Symbol inAttributeName, Symbol inAttributeValue);
+
 	std::string name;
 	std::string type;
 	int nodeCount;
-	int edgeCount;
-	mutable std::unordered_map<std::string, std::shared_ptr<Node> > nodesByName;
-	mutable std::map<int, std::shared_ptr<Node> > nodesByIndex;
-	mutable std::map<std::pair<std::string, std::string>, std::shared_ptr<Edge> > edgesByNodesNames;
-	mutable std::map<std::pair<int, int>, std::shared_ptr<Edge> > edgesByNodesIndex;
-    arma::mat adjacencyList;
+	int version;
+	std::vector<GraphOperation> operations;
+	bool bIsInTransaction;
+	size_t transactionOperationCount; //Size of the operations journal when the transaction began
+	int transactionNodeCount;
+	int transactionEdgeHandleCount;
+	std::vector<GraphUndoRecord> undoLog;
+	MatchPlan matchPlan;
+	std::shared_ptr<const GraphSnapshot> snapshot;
+	Pool<Node> nodes; //Handles are the nodes indexes
+	Pool<Edge> edges;
+	std::unordered_map<Symbol, int> nodesByName;
+	std::map<std::pair<Symbol, Symbol>, int> edgesByNodesNames;
+	std::map<std::pair<int, int>, int> edgesByNodesIndex;
+	std::unordered_map<Symbol, std::vector<int> > nodesIndexesByAttributeName; //Sorted posting lists of nodes holding an attribute, whatever its value
+	std::unordered_map<Symbol, std::unordered_map<Symbol, std::vector<int> > > nodesIndexesByAttribute; //Sorted posting lists of nodes holding an attribute with a given value
+    BitMatrix adjacencyList;
+    BitMatrix incomingAdjacencyList;
 };
 
 #endif // GRAPH_H
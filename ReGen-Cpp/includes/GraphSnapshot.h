@@ -0,0 +1,62 @@
+#ifndef GRAPH_SNAPSHOT_H
+#define GRAPH_SNAPSHOT_H
+
+#include <span>
+
+#include "Graph.h"
+
+//Immutable compressed sparse row copy of a graph that is only read once loaded (the world graph): nodes and edges are indexes into contiguous arrays instead of shared pointers
+class GraphSnapshot
+{
+public:
+	explicit GraphSnapshot(const Graph& inGraph);
+
+	//Version of the graph the snapshot was taken from
+	[[nodiscard]] int getVersion() const;
+	[[nodiscard]] int getNodeCount() const;
+	[[nodiscard]] bool hasNode(int inNodeIndex) const;
+	[[nodiscard]] Symbol getNodeName(int inNodeIndex) const;
+	//Empty symbol if the node doesn't hold the attribute
+	[[nodiscard]] Symbol getNodeAttribute(int inNodeIndex, Symbol inAttributeName) const;
+
+	//Edges indexes, in the order they were added to the node
+	[[nodiscard]] std::span<const int> getOutgoingEdges(int inNodeIndex) const;
+	[[nodiscard]] std::span<const int> getIncomingEdges(int inNodeIndex) const;
+	//Nodes at the other end of getOutgoingEdges/getIncomingEdges, in the same order
+	[[nodiscard]] std::span<const int> getOutgoingNeighbours(int inNodeIndex) const;
+	[[nodiscard]] std::span<const int> getIncomingNeighbours(int inNodeIndex) const;
+	[[nodiscard]] int getEdgeSource(int inEdgeIndex) const;
+	[[nodiscard]] int getEdgeTarget(int inEdgeIndex) const;
+	[[nodiscard]] std::span<const std::pair<Symbol, Symbol> > getEdgeAttributes(int inEdgeIndex) const;
+	//Null if the edge doesn't hold the attribute
+	[[nodiscard]] const std::pair<Symbol, Symbol>* findEdgeAttribute(int inEdgeIndex, Symbol inAttributeName) const;
+	//NONE if there is no such edge
+	[[nodiscard]] int findEdge(int inSourceIndex, int inTargetIndex) const;
+	[[nodiscard]] int findSourceNodeFromIncomingEdgeWithAttribute(int inNodeIndex, const std::pair<Symbol, Symbol>& inAttribute) const;
+	[[nodiscard]] int findTargetNodeFromOutgoingEdgeWithAttribute(int inNodeIndex, const std::pair<Symbol, Symbol>& inAttribute) const;
+
+	//Same as Graph::containsEdges, for edges of the snapshot
+	[[nodiscard]] bool containsEdges(std::span<const int> inEdgesIndexes, const Graph& inParentGraph, const std::vector<int>& inParentEdges) const;
+	//Whether the edge holds one of the parent edge attributes
+	[[nodiscard]] bool containsEdgeAttribute(int inEdgeIndex, const Edge& inParentEdge) const;
+
+private:
+	int version;
+	int nodeCount;
+	std::vector<Symbol> nodesNames; //Empty for removed nodes
+	std::unordered_map<Symbol, std::vector<Symbol> > attributesColumns; //One value per node, empty when the node doesn't hold the attribute
+
+	std::vector<int> outgoingOffsets;
+	std::vector<int> outgoingEdges;
+	std::vector<int> outgoingNeighbours;
+	std::vector<int> incomingOffsets;
+	std::vector<int> incomingEdges;
+	std::vector<int> incomingNeighbours;
+
+	std::vector<int> edgesSources;
+	std::vector<int> edgesTargets;
+	std::vector<int> edgesAttributesOffsets;
+	std::vector<std::pair<Symbol, Symbol> > edgesAttributes;
+};
+
+#endif // GRAPH_SNAPSHOT_H
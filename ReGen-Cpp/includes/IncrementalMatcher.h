@@ -0,0 +1,28 @@
+#ifndef INCREMENTAL_MATCHER_H
+#define INCREMENTAL_MATCHER_H
+
+#include <functional>
+
+#include "Graph.h"
+
+//Keeps the mappings of several searched graphs into a graph that is being modified (the story graph) up to date from the graph's operations journal,
+//so that each modification costs a search around the modified nodes instead of a search of the whole graph
+class IncrementalMatcher
+{
+public:
+	IncrementalMatcher(const Graph& inGraph, const std::list<const Graph*>& inSearchedGraphs);
+
+	//Brings the mappings up to date with the operations applied to inGraph since the last update. inGraph may be a copy of the graph the mappings were found in
+	void update(const Graph& inGraph);
+	//Every mapping of inSearchedGraph as of the last update, as node indexes ordered by searched node index. Mappings are sorted and unique, and can be picked by position
+	[[nodiscard]] const std::vector<std::vector<int> >& getMappings(const Graph& inSearchedGraph) const;
+
+private:
+	void search(const Graph& inGraph);
+	void forEachSearchedGraph(const std::function<void(const Graph&, std::vector<std::vector<int> >&)>& inFunction);
+
+	std::map<const Graph*, std::vector<std::vector<int> > > mappings;
+	size_t operationCount;
+};
+
+#endif // INCREMENTAL_MATCHER_H
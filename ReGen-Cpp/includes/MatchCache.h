@@ -0,0 +1,35 @@
+#ifndef MATCH_CACHE_H
+#define MATCH_CACHE_H
+
+#include <future>
+
+#include "Graph.h"
+#include "Singleton.h"
+
+//Keeps the mappings found between long-lived graphs (world graph and rules conditions) so that they are only searched once for all generated stories
+class MatchCache final : public Singleton<MatchCache>
+{
+	friend class Singleton<MatchCache>;
+
+public:
+	//Every mapping of inSearchedGraph into inGraph, as node indexes ordered by searched node index. Searched again only if one of the graphs was modified
+	const std::vector<std::vector<int> >& getMappings(const Graph& inGraph, const Graph& inSearchedGraph);
+	//Reads mappings saved by a previous run, entries not matching the content of the given graphs or naming nodes inGraph doesn't hold are ignored
+	void load(const std::string& inPath, const Graph& inGraph, const std::list<const Graph*>& inSearchedGraphs);
+	void save(const std::string& inPath) const;
+	//Drops the mappings involving the graph, for graphs replaced by new ones at the same address whose versions could match the old entries
+	void forget(const Graph& inGraph);
+
+private:
+	struct Entry
+	{
+		int graphVersion;
+		int searchedGraphVersion;
+		std::shared_future<std::vector<std::vector<int> > > mappings;
+	};
+
+	std::map<std::pair<const Graph*, const Graph*>, Entry> entries;
+	mutable std::mutex entriesMutex;
+};
+
+#endif // MATCH_CACHE_H
@@ -0,0 +1,49 @@
+#ifndef OUTPUT_PIPELINE_H
+#define OUTPUT_PIPELINE_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <thread>
+
+#include "Graph.h"
+#include "Singleton.h"
+
+//Writes finished graphs and renders them with Graphviz on its own threads, so that generating stories never waits on the output.
+//Its workers are kept apart from the ThreadPool, a rendering blocked on an external process can't hold back the generation tasks
+class OutputPipeline final : public Singleton<OutputPipeline>
+{
+	friend class Singleton<OutputPipeline>;
+
+public:
+	//Outputs waiting for a worker above which queuing blocks, so that slow rendering bounds the finished stories held in memory instead of letting them pile up
+	static constexpr size_t MAX_PENDING_OUTPUTS = 32;
+
+	//Takes the graph, writes it in DOT format then renders it in the background
+	void save(Graph&& inGraph, std::string inColor = "ivory4", std::string inFontColor = "ivory4", std::string inOutputPath = "./Output");
+	//Renders an already written DOT file in the background
+	void render(std::string inDotFilePath);
+	//When disabled, only the DOT files are written. To be set before queuing outputs
+	void setRenderImages(bool bInRenderImages);
+	//Waits until every queued output is written and rendered, to be called before exiting since the workers are detached
+	void flush();
+
+private:
+	OutputPipeline();
+
+	void push(std::function<void()>&& inOutput);
+	void work();
+	void renderImage(const std::string& inDotFilePath) const;
+
+	std::vector<std::thread> workers;
+	std::deque<std::function<void()> > outputs;
+	size_t unfinishedOutputCount; //Queued or being run
+	std::mutex outputsMutex;
+	std::condition_variable outputsCondition;
+	std::condition_variable spaceCondition;
+	std::condition_variable finishedCondition;
+	std::atomic<bool> bRenderImages;
+};
+
+#endif // OUTPUT_PIPELINE_H
@@ -0,0 +1,131 @@
+#ifndef POOL_H
+#define POOL_H
+
+#include <algorithm>
+
+//Stores objects in fixed size blocks addressed by integer handles, objects never move when the pool grows so that references to them stay valid.
+//The handles of destroyed objects are reused by later creations, and the blocks are only released all at once with the pool
+template<class T> class Pool
+{
+public:
+	static constexpr int BLOCK_SIZE = 256;
+
+	Pool() = default;
+	Pool(const Pool& inPool);
+	Pool(Pool&& inPool) noexcept = default;
+	Pool& operator=(const Pool& inPool);
+	Pool& operator=(Pool&& inPool) noexcept = default;
+	~Pool() = default;
+
+	template<class... Arguments> int create(Arguments&&... inArguments);
+	void destroy(int inHandle);
+	//Brings back the object of the last destroyed handle, so that destructions reverted in reverse order leave the handles as they were
+	template<class... Arguments> void restore(int inHandle, Arguments&&... inArguments);
+	//Forgets the handles from inHandleCount onward, whose objects must all have been destroyed, as if they had never been given
+	void shrink(int inHandleCount);
+	[[nodiscard]] bool contains(int inHandle) const;
+	T& operator[](int inHandle);
+	const T& operator[](int inHandle) const;
+	//Every handle given so far is lower than this count, whether its object was destroyed or not
+	[[nodiscard]] int getHandleCount() const;
+	[[nodiscard]] int getSize() const;
+
+private:
+	std::vector<std::unique_ptr<T[]> > blocks;
+	std::vector<bool> liveHandles;
+	std::vector<int> freeHandles;
+};
+
+template<class T> Pool<T>::Pool(const Pool& inPool) : liveHandles(inPool.liveHandles), freeHandles(inPool.freeHandles)
+{
+	blocks.reserve(inPool.blocks.size());
+	for(const auto& block : inPool.blocks)
+	{
+		blocks.emplace_back(new T[BLOCK_SIZE]);
+		std::copy_n(block.get(), BLOCK_SIZE, blocks.back().get());
+	}
+}
+
+template<class T> Pool<T>& Pool<T>::operator=(const Pool& inPool)
+{
+	if(this != &inPool)
+	{
+		*this = Pool(inPool);
+	}
+	return *this;
+}
+
+template<class T> template<class... Arguments> int Pool<T>::create(Arguments&&... inArguments)
+{
+	int handle;
+	if(!freeHandles.empty())
+	{
+		handle = freeHandles.back();
+		freeHandles.pop_back();
+		liveHandles[handle] = true;
+	}
+	else
+	{
+		handle = static_cast<int>(liveHandles.size());
+		liveHandles.emplace_back(true);
+		if(handle / BLOCK_SIZE == static_cast<int>(blocks.size()))
+		{
+			blocks.emplace_back(new T[BLOCK_SIZE]);
+		}
+	}
+	(*this)[handle] = T(std::forward<Arguments>(inArguments)...);
+	return handle;
+}
+
+template<class T> void Pool<T>::destroy(const int inHandle)
+{
+	assert(contains(inHandle));
+	(*this)[inHandle] = T(); //Releases what the object owns, its slot stays allocated for the next creation
+	liveHandles[inHandle] = false;
+	freeHandles.emplace_back(inHandle);
+}
+
+template<class T> template<class... Arguments> void Pool<T>::restore(const int inHandle, Arguments&&... inArguments)
+{
+	assert(!freeHandles.empty() && freeHandles.back() == inHandle);
+	freeHandles.pop_back();
+	liveHandles[inHandle] = true;
+	(*this)[inHandle] = T(std::forward<Arguments>(inArguments)...);
+}
+
+template<class T> void Pool<T>::shrink(const int inHandleCount)
+{
+	assert(std::none_of(liveHandles.begin() + std::min(inHandleCount, getHandleCount()), liveHandles.end(), [](const bool inIsLive){ return inIsLive; }));
+	if(inHandleCount < getHandleCount())
+	{
+		std::erase_if(freeHandles, [inHandleCount](const int inHandle){ return inHandle >= inHandleCount; });
+		liveHandles.resize(inHandleCount);
+	}
+}
+
+template<class T> bool Pool<T>::contains(const int inHandle) const
+{
+	return inHandle >= 0 && inHandle < static_cast<int>(liveHandles.size()) && liveHandles[inHandle];
+}
+
+template<class T> T& Pool<T>::operator[](const int inHandle)
+{
+	return blocks[inHandle / BLOCK_SIZE][inHandle % BLOCK_SIZE];
+}
+
+template<class T> const T& Pool<T>::operator[](const int inHandle) const
+{
+	return blocks[inHandle / BLOCK_SIZE][inHandle % BLOCK_SIZE];
+}
+
+template<class T> int Pool<T>::getHandleCount() const
+{
+	return static_cast<int>(liveHandles.size());
+}
+
+template<class T> int Pool<T>::getSize() const
+{
+	return static_cast<int>(liveHandles.size() - freeHandles.size());
+}
+
+#endif // POOL_H
@@ -12,7 +12,9 @@ struct Rule
 	Graph socialConditions;
 	Graph storyConditions;
 	Graph storyGraph;
-	std::unordered_map<std::string, std::list<CommandData> > nodeModificationArguments;
+	std::vector<std::shared_ptr<const std::vector<CompiledCommand> > > nodesModifications; //Commands of each story graph node, by node index. Nodes holding the same modification share its commands
+	std::vector<int> socialNodesRolesSlots; //Slot of the role each social condition node stands for, by node index
+	std::vector<int> storyNodesTargetsSlots; //Slot of the role targeted by each story graph node, by node index
 	bool appliesOnce;
 };
 
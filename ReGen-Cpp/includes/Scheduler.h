@@ -1,29 +1,54 @@
 #ifndef SCHEDULER_H
 #define SCHEDULER_H
 
+#include <functional>
 #include <random>
 
+#include "WeightedSampler.h"
+
 struct Rule;
 class Graph;
+class IncrementalMatcher;
 
-//TODO threading
+//Generates a story. Each story draws from its own random engine, so that stories can be generated concurrently and reproduced from their seed
 class Scheduler 
 {
 public:
-	explicit Scheduler(std::string inQuestName);
+	Scheduler(std::string inQuestName, uint64_t inSeed);
+	//Picks the initialization rule among those that can still be used, and counts its usage
+	void pickInitializationRule(std::unordered_map<std::string, int>& ioRulesUsages);
 	void run();
+	//Generates the stories on the thread pool. Their seeds are derived from the master seed and their index, so that the stories are the same whatever the number of threads
+	static void runBatch(const std::string& inQuestNamePrefix, int inStoryCount, uint64_t inMasterSeed);
 
 private:
-	static void getPossibleRules(const std::list<Rule>& inRuleSet, const Graph& inGraph, const std::unordered_map<std::string, int>& inRuleUsages, std::unordered_map<Rule, std::list<std::list<std::shared_ptr<class Node> > >, struct RuleHashFunction>& outPossibleRules);
-	static bool rewriteStory(const Graph& inStory, const std::unordered_map<std::string, std::shared_ptr<Node> >& inCast, std::unordered_map<std::string, int>& inRuleUsages, Graph& outStory);
+	//Weights of the rules of a rule set by rule position, null for the rules that aren't possible. Kept between picks,
+	//so that only the weights of the rules whose possibility or usage changed are computed again
+	struct RulesWeights
+	{
+		std::vector<const Rule*> rules;
+		WeightedSampler sampler;
+		std::vector<int> weightedUsages; //Usage each weight was computed for, NONE for null weights
+	};
+
+	static void getPossibleRules(const std::list<Rule>& inRuleSet, const std::unordered_map<std::string, int>& inRuleUsages, const std::function<bool(const Rule&)>& inIsPossible, std::vector<const Rule*>& outPossibleRules);
+	//Picks one of the possible rules, in rule set order. Uniformly, or with a probability proportional to its weight if the test layout weights rules by metrics
+	const Rule& pickRule(const std::list<Rule>& inRuleSet, const std::vector<const Rule*>& inPossibleRules, const std::unordered_map<std::string, int>& inRuleUsages, RulesWeights& ioRulesWeights);
+	//Weight of the rule derived from the metrics to optimize of the test layout, 1 if there is none
+	static double getRuleWeight(const Rule& inRule, int inRuleUsages);
+	//Rewrite rules usages are counted per story
+	bool rewriteStory(Graph& ioStory, const class Cast& inCast, std::unordered_map<std::string, int>& inRuleUsages, IncrementalMatcher& ioStoryMatcher);
 #ifndef NDEBUG
 	static void printNodeConditions(const std::string& inNodeName, std::shared_ptr<struct ConditionsBlock> inConditionsBlock);
 #endif
-	static void createNodeConditions(const std::unordered_map<std::string, std::list<struct CommandData>>& inRuleCommandsData, const std::unordered_map<std::string, std::shared_ptr<Node>>& inCast, std::shared_ptr<Node> inNode);
+	static void createNodeConditions(const std::vector<struct CompiledCommand>& inCommands, const Cast& inCast, const class Node& inNode);
+
+	static uint64_t getStorySeed(uint64_t inMasterSeed, int inStoryIndex);
 
-	static std::default_random_engine randomEngine;
-	static std::unordered_map<std::string, int> rulesUsages;
+	std::default_random_engine randomEngine;
+	const Rule* initializationRule;
 	std::string questName;
+	RulesWeights rewriteRulesWeights;
 };
 
 #endif // SCHEDULER_H
@@ -0,0 +1,46 @@
+#ifndef SUB_GRAPH_MATCHER_H
+#define SUB_GRAPH_MATCHER_H
+
+#include "Graph.h"
+
+//Pull-based enumeration of the subgraphs of a graph isomorphic to a searched graph, the search space is only explored as far as the caller asks for.
+//Mappings are injective: two searched nodes are never mapped to the same node, even when no edge links them
+class SubGraphMatcher
+{
+public:
+	//When given, the anchored searched node can only be mapped to the anchor node, so that only the mappings involving a given node are enumerated
+	SubGraphMatcher(const Graph& inGraph, const Graph& inSearchedGraph, int inAnchoredSearchedNodeIndex = NONE, int inAnchorNodeIndex = NONE);
+
+	//Advances to the next mapping, returns false once every mapping has been found
+	bool next();
+	//Index of the node mapped to each searched node, ordered by searched node index whatever the order they were mapped in
+	[[nodiscard]] const std::vector<int>& getMapping() const;
+	void getSubNodes(std::list<const Node*>& outFoundSubNodes) const;
+
+private:
+	void findSubNodes(int inSearchedNodeIndex, const Node& inSearchedNode);
+	[[nodiscard]] bool hasSubNodeEdges(int inNodeIndex, const Node& inSearchedNode) const;
+	bool refineSubNodes();
+	void computeFeasibleSubNodes(int inStep);
+	[[nodiscard]] bool isMappingConsistent(int inCandidateIndex) const;
+	void pushMapping(int inNodeIndex);
+	void popMapping();
+	[[nodiscard]] bool isMappingInjective() const;
+
+	const Graph& graph;
+	const Graph& searchedGraph;
+	const GraphSnapshot* snapshot; //Read instead of the graph when it is frozen
+	MatchPlan ownPlan;
+	const MatchPlan* plan;
+	size_t wordCount;
+	BitMatrix subNodes; //Indexed by searched node
+	BitMatrix feasibleSubNodes; //Indexed by plan step
+	std::vector<BitMatrix::Word> usedNodes;
+	std::vector<int> mapping;
+	int mappedCount;
+	std::vector<size_t> nextCandidates; //Indexed by plan step
+	bool bHasStarted;
+	bool bIsExhausted;
+};
+
+#endif // SUB_GRAPH_MATCHER_H
@@ -0,0 +1,79 @@
+#ifndef SYMBOL_H
+#define SYMBOL_H
+
+#include <array>
+#include <cstdint>
+#include <string_view>
+
+#include "Singleton.h"
+
+//Interned string: equal strings share the same 32 bits id, so that comparing or hashing them costs an integer operation
+class Symbol
+{
+public:
+	Symbol();
+	//Strings convert implicitly, they are interned at the conversion
+	Symbol(const char* inString); // NOLINT(google-explicit-constructor)
+	Symbol(const std::string& inString); // NOLINT(google-explicit-constructor)
+	Symbol(std::string_view inString); // NOLINT(google-explicit-constructor)
+
+	[[nodiscard]] const std::string& getString() const;
+	[[nodiscard]] uint32_t getId() const;
+
+	bool operator==(const Symbol&) const = default;
+	//Ordered by id, not alphabetically
+	auto operator<=>(const Symbol&) const = default;
+	//Comparing with a string would intern it on each comparison, compare with a symbol interned beforehand instead
+	bool operator==(const char*) const = delete;
+	bool operator==(const std::string&) const = delete;
+
+private:
+	uint32_t id;
+};
+
+template<> struct std::hash<Symbol>
+{
+	size_t operator()(const Symbol& inSymbol) const noexcept
+	{
+		return inSymbol.getId();
+	}
+};
+
+//Symbols compared in hot loops or given to every story, interned once rather than on each use
+namespace Symbols
+{
+	inline const Symbol NOT_AVAILABLE("N/A");
+	inline const Symbol TARGET("target");
+	inline const Symbol NAME("name");
+	inline const Symbol STRING_TYPE("str");
+	inline const Symbol NODE_TYPE("Node_Type");
+	inline const Symbol START_QUEST("Start_Quest");
+	inline const Symbol END_QUEST("End_Quest");
+	inline const Symbol START("Start");
+	inline const Symbol END("End");
+}
+
+class SymbolTable final : public Singleton<SymbolTable>
+{
+	friend class Singleton<SymbolTable>;
+
+public:
+	uint32_t intern(std::string_view inString);
+	[[nodiscard]] const std::string& getString(uint32_t inId) const;
+	//Ids are given in interning order, every id lower than this count is taken
+	[[nodiscard]] uint32_t getSymbolCount() const;
+
+private:
+	SymbolTable();
+
+	static constexpr size_t CHUNK_SIZE = 4096;
+	static constexpr size_t CHUNK_COUNT = 4096;
+
+	//Interned strings never move, so that they can be read without locking while other strings are interned
+	std::array<std::unique_ptr<std::string[]>, CHUNK_COUNT> chunks;
+	std::unordered_map<std::string_view, uint32_t> ids;
+	uint32_t symbolCount;
+	mutable std::mutex internMutex;
+};
+
+#endif // SYMBOL_H
@@ -5,8 +5,13 @@ struct TestLayout
 {
 	int numStoryToGenerate;
 	int maxNumberOfRewrites;
+	uint64_t seed; //Master seed the random engines of the stories are derived from, random if the layout doesn't give one
 	std::list<std::pair<std::string, int> > metricsToOptimize;
 	std::list<std::string> metricsToAnalyze;	
+	bool bWeightRulesByMetrics = false; //Whether rules are drawn with weights estimated from the metrics to optimize rather than uniformly
+	bool bRenderImages = true; //Whether the written stories are also rendered as PNG images, which requires Graphviz
+	bool bWatchSources = false; //Whether a new batch is generated each time the layout, the world graph or a rule is changed, rather than exiting after the first one
+	unsigned threadCount = 0; //Threads generating the stories, the calling one included, 0 for one per core. Stories are the same whatever the count
 };
 
 #endif // TESTLAYOUT_H
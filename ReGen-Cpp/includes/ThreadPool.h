@@ -0,0 +1,71 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <thread>
+
+#include "Singleton.h"
+
+class ThreadPool final : public Singleton<ThreadPool>
+{
+	friend class Singleton<ThreadPool>;
+
+public:
+	//Tasks submitted together to be waited for together
+	using TaskGroup = uint64_t;
+
+	[[nodiscard]] TaskGroup createTaskGroup();
+	template<class Function> std::future<std::invoke_result_t<Function>> submit(TaskGroup inGroup, Function&& inFunction);
+	//Runs pending tasks of the group while the result isn't ready, so that tasks waiting on tasks they submitted can't starve the pool.
+	//Tasks of other groups are left to the workers, a waiting story would otherwise run other whole stories nested on its stack
+	template<class Result> Result wait(TaskGroup inGroup, std::future<Result>& ioFuture);
+	//Threads running tasks, the waiting one included. Starts at one per core
+	[[nodiscard]] size_t getThreadCount() const;
+	//Workers are started or retired to match, 0 gives one thread per core. Retired workers finish the task they run first
+	void setThreadCount(size_t inThreadCount);
+
+private:
+	struct Task
+	{
+		TaskGroup group;
+		std::function<void()> function;
+	};
+
+	ThreadPool();
+
+	void work();
+	bool runPendingTask(TaskGroup inGroup);
+
+	size_t workerCount; //Running workers, including the ones about to retire
+	size_t targetWorkerCount;
+	std::deque<Task> tasks;
+	std::atomic<TaskGroup> nextGroup;
+	mutable std::mutex tasksMutex;
+	std::condition_variable tasksCondition;
+};
+
+template<class Function> std::future<std::invoke_result_t<Function>> ThreadPool::submit(const TaskGroup inGroup, Function&& inFunction)
+{
+	auto task = std::make_shared<std::packaged_task<std::invoke_result_t<Function>()> >(std::forward<Function>(inFunction));
+	auto result = task->get_future();
+	{
+		std::lock_guard lock(tasksMutex);
+		tasks.emplace_back(inGroup, [task](){ (*task)(); });
+	}
+	tasksCondition.notify_one();
+	return result;
+}
+
+template<class Result> Result ThreadPool::wait(const TaskGroup inGroup, std::future<Result>& ioFuture)
+{
+	while(ioFuture.wait_for(std::chrono::seconds(0)) != std::future_status::ready && runPendingTask(inGroup))
+	{
+	}
+	return ioFuture.get();
+}
+
+#endif // THREAD_POOL_H
@@ -0,0 +1,25 @@
+#ifndef WEIGHTED_SAMPLER_H
+#define WEIGHTED_SAMPLER_H
+
+#include <random>
+
+//Draws indexes with a probability proportional to their weight. Weights are kept in a Fenwick tree, so that both drawing an index and changing a weight cost O(log n)
+class WeightedSampler
+{
+public:
+	WeightedSampler() = default;
+	explicit WeightedSampler(const std::vector<double>& inWeights);
+
+	[[nodiscard]] size_t getSize() const;
+	[[nodiscard]] double getTotalWeight() const;
+	//Weights must not be negative
+	void setWeight(size_t inIndex, double inWeight);
+	//The total weight must be positive
+	[[nodiscard]] size_t sample(std::default_random_engine& inRandomEngine) const;
+
+private:
+	std::vector<double> weights;
+	std::vector<double> partialSums; //Fenwick tree, one-based: partialSums[i] sums the weights of ]i - lowbit(i), i]
+};
+
+#endif // WEIGHTED_SAMPLER_H
@@ -0,0 +1,63 @@
+#ifndef XML_STREAM_READER_H
+#define XML_STREAM_READER_H
+
+#include <fstream>
+#include <string_view>
+
+//Reads an XML file one element at a time without building a document, so that large files are loaded holding little more than what is made of them.
+//Comments, processing instructions and doctypes are skipped, entities are decoded and line ends normalized the way pugixml does by default.
+//Unlike pugixml, unknown entities are errors, as are unclosed or mismatched elements and a file ending inside markup
+class XmlStreamReader
+{
+public:
+	enum class Event
+	{
+		StartElement,
+		EndElement, //Also sent right after the start of a self-closing element
+		Text, //Text made of whitespaces alone is skipped
+		EndOfDocument,
+		Error //Sent once the document is found malformed, and again by every later call
+	};
+
+	explicit XmlStreamReader(const std::string& inPath);
+
+	[[nodiscard]] bool isOpen() const;
+	Event next();
+	//Element of the last StartElement or EndElement event
+	[[nodiscard]] const std::string& getName() const;
+	//Text of the last Text event
+	[[nodiscard]] const std::string& getText() const;
+	//Attributes of the last StartElement event, in document order
+	[[nodiscard]] size_t getAttributeCount() const;
+	[[nodiscard]] const std::pair<std::string, std::string>& getAttribute(size_t inPosition) const;
+	//Empty if the element has no such attribute
+	[[nodiscard]] std::string_view getAttribute(std::string_view inName) const;
+	//What was malformed and on which line, empty until an Error event
+	[[nodiscard]] const std::string& getError() const;
+
+private:
+	int peek();
+	int get();
+	void skipWhitespaces();
+	void readName(std::string& outName);
+	//Reads up to the next inDelimiter, which is consumed, decoding entities and line ends. False on an unknown entity
+	bool readValue(int inDelimiter, bool bInNormalizeWhitespaces, std::string& outValue);
+	//Skips everything up to inTerminator included, the skipped characters are appended to outSkipped if given. False if the file ends first
+	bool skipPast(std::string_view inTerminator, std::string* outSkipped = nullptr);
+	bool readEntity(std::string& ioValue);
+	Event fail(std::string_view inMessage);
+
+	std::ifstream file;
+	std::streambuf* buffer;
+	std::string name;
+	std::string text;
+	std::vector<std::pair<std::string, std::string> > attributes; //Only the first attributeCount are the current element's, the others keep their storage for the next ones
+	size_t attributeCount;
+	bool bIsSelfClosing;
+	std::vector<std::string> openElements;
+	bool bHasRootElement;
+	int line;
+	std::string error;
+};
+
+#endif // XML_STREAM_READER_H
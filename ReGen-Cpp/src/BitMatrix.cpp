@@ -0,0 +1,224 @@
+#include "BitMatrix.h"
+
+#include <algorithm>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+BitMatrix::BitMatrix() : rowCount(0), columnCount(0), wordsPerRow(0)
+{
+}
+
+BitMatrix::BitMatrix(const size_t inRowCount, const size_t inColumnCount) : rowCount(inRowCount), columnCount(inColumnCount), wordsPerRow(toWordCount(inColumnCount)), words(inRowCount * wordsPerRow, 0)
+{
+}
+
+size_t BitMatrix::getRowCount() const
+{
+	return rowCount;
+}
+
+size_t BitMatrix::getColumnCount() const
+{
+	return columnCount;
+}
+
+size_t BitMatrix::getWordsPerRow() const
+{
+	return wordsPerRow;
+}
+
+bool BitMatrix::at(const size_t inRow, const size_t inColumn) const
+{
+	assert(inRow < rowCount && inColumn < columnCount);
+	return test(getRow(inRow), inColumn);
+}
+
+void BitMatrix::set(const size_t inRow, const size_t inColumn)
+{
+	assert(inRow < rowCount && inColumn < columnCount);
+	set(getRow(inRow), inColumn);
+}
+
+void BitMatrix::reset(const size_t inRow, const size_t inColumn)
+{
+	assert(inRow < rowCount && inColumn < columnCount);
+	reset(getRow(inRow), inColumn);
+}
+
+const BitMatrix::Word* BitMatrix::getRow(const size_t inRow) const
+{
+	return words.data() + inRow * wordsPerRow;
+}
+
+BitMatrix::Word* BitMatrix::getRow(const size_t inRow)
+{
+	return words.data() + inRow * wordsPerRow;
+}
+
+size_t BitMatrix::countRow(const size_t inRow) const
+{
+	return count(getRow(inRow), wordsPerRow);
+}
+
+void BitMatrix::resize(const size_t inRowCount, const size_t inColumnCount)
+{
+	if(const auto requiredWordsPerRow = toWordCount(inColumnCount); requiredWordsPerRow > wordsPerRow)
+	{
+		const auto newWordsPerRow = std::max(requiredWordsPerRow, wordsPerRow * 2);
+		std::vector<Word> newWords;
+		newWords.reserve(std::max(inRowCount, rowCount) * newWordsPerRow);
+		newWords.resize(rowCount * newWordsPerRow, 0);
+		for(size_t row = 0; row < rowCount; ++row)
+		{
+			std::copy_n(getRow(row), wordsPerRow, newWords.data() + row * newWordsPerRow);
+		}
+		words = std::move(newWords);
+		wordsPerRow = newWordsPerRow;
+	}
+	else if(inColumnCount < columnCount) //Shrinking must not leave stale bits behind the last column
+	{
+		for(size_t row = 0; row < rowCount; ++row)
+		{
+			for(auto column = inColumnCount; column < columnCount; ++column)
+			{
+				reset(getRow(row), column);
+			}
+		}
+	}
+
+	words.resize(inRowCount * wordsPerRow, 0);
+	rowCount = inRowCount;
+	columnCount = inColumnCount;
+}
+
+void BitMatrix::clear()
+{
+	std::ranges::fill(words, 0);
+}
+
+void BitMatrix::andRows(Word* ioDestination, const Word* inSource, const size_t inWordCount)
+{
+	size_t wordIndex = 0;
+#if defined(__AVX2__)
+	for(; wordIndex + 4 <= inWordCount; wordIndex += 4)
+	{
+		const auto destination = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(ioDestination + wordIndex));
+		const auto source = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(inSource + wordIndex));
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(ioDestination + wordIndex), _mm256_and_si256(destination, source));
+	}
+#endif
+	for(; wordIndex < inWordCount; ++wordIndex)
+	{
+		ioDestination[wordIndex] &= inSource[wordIndex];
+	}
+}
+
+void BitMatrix::andNotRows(Word* ioDestination, const Word* inSource, const size_t inWordCount)
+{
+	size_t wordIndex = 0;
+#if defined(__AVX2__)
+	for(; wordIndex + 4 <= inWordCount; wordIndex += 4)
+	{
+		const auto destination = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(ioDestination + wordIndex));
+		const auto source = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(inSource + wordIndex));
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(ioDestination + wordIndex), _mm256_andnot_si256(source, destination));
+	}
+#endif
+	for(; wordIndex < inWordCount; ++wordIndex)
+	{
+		ioDestination[wordIndex] &= ~inSource[wordIndex];
+	}
+}
+
+void BitMatrix::orRows(Word* ioDestination, const Word* inSource, const size_t inWordCount)
+{
+	size_t wordIndex = 0;
+#if defined(__AVX2__)
+	for(; wordIndex + 4 <= inWordCount; wordIndex += 4)
+	{
+		const auto destination = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(ioDestination + wordIndex));
+		const auto source = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(inSource + wordIndex));
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(ioDestination + wordIndex), _mm256_or_si256(destination, source));
+	}
+#endif
+	for(; wordIndex < inWordCount; ++wordIndex)
+	{
+		ioDestination[wordIndex] |= inSource[wordIndex];
+	}
+}
+
+bool BitMatrix::intersects(const Word* inFirstRow, const Word* inSecondRow, const size_t inWordCount)
+{
+	size_t wordIndex = 0;
+#if defined(__AVX2__)
+	for(; wordIndex + 4 <= inWordCount; wordIndex += 4)
+	{
+		const auto first = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(inFirstRow + wordIndex));
+		const auto second = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(inSecondRow + wordIndex));
+		if(!_mm256_testz_si256(first, second))
+		{
+			return true;
+		}
+	}
+#endif
+	for(; wordIndex < inWordCount; ++wordIndex)
+	{
+		if(inFirstRow[wordIndex] & inSecondRow[wordIndex])
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+size_t BitMatrix::count(const Word* inRow, const size_t inWordCount)
+{
+	size_t result = 0;
+	for(size_t wordIndex = 0; wordIndex < inWordCount; ++wordIndex)
+	{
+		result += static_cast<size_t>(std::popcount(inRow[wordIndex]));
+	}
+	return result;
+}
+
+bool BitMatrix::test(const Word* inRow, const size_t inColumn)
+{
+	return (inRow[inColumn / WORD_SIZE] >> (inColumn % WORD_SIZE)) & 1;
+}
+
+void BitMatrix::set(Word* ioRow, const size_t inColumn)
+{
+	ioRow[inColumn / WORD_SIZE] |= Word{1} << (inColumn % WORD_SIZE);
+}
+
+void BitMatrix::reset(Word* ioRow, const size_t inColumn)
+{
+	ioRow[inColumn / WORD_SIZE] &= ~(Word{1} << (inColumn % WORD_SIZE));
+}
+
+size_t BitMatrix::toWordCount(const size_t inColumnCount)
+{
+	return (inColumnCount + WORD_SIZE - 1) / WORD_SIZE;
+}
+
+size_t BitMatrix::findNextSetBit(const Word* inRow, const size_t inWordCount, const size_t inColumn)
+{
+	auto wordIndex = inColumn / WORD_SIZE;
+	if(wordIndex >= inWordCount)
+	{
+		return inWordCount * WORD_SIZE;
+	}
+
+	Word word = inRow[wordIndex] & (~Word{0} << (inColumn % WORD_SIZE));
+	while(!word)
+	{
+		if(++wordIndex == inWordCount)
+		{
+			return inWordCount * WORD_SIZE;
+		}
+		word = inRow[wordIndex];
+	}
+	return wordIndex * WORD_SIZE + static_cast<size_t>(std::countr_zero(word));
+}
@@ -0,0 +1,276 @@
+#include "Bundle.h"
+
+#include <filesystem>
+#include <fstream>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+	constexpr char MAGIC[4] = {'R', 'G', 'N', 'B'};
+
+	//FNV-1a, continued from inHash so that data in several parts hashes as a whole
+	uint64_t computeChecksum(const std::string_view inData, uint64_t inHash = 14695981039346656037ull)
+	{
+		for(const auto character : inData)
+		{
+			inHash = (inHash ^ static_cast<unsigned char>(character)) * 1099511628211ull;
+		}
+		return inHash;
+	}
+}
+
+FileStamp FileStamp::read(const std::string& inPath)
+{
+	std::error_code error;
+	const auto fileSize = std::filesystem::file_size(inPath, error);
+	if(error)
+	{
+		return {};
+	}
+	const auto writeTime = std::filesystem::last_write_time(inPath, error);
+	return {fileSize, error ? 0 : static_cast<int64_t>(writeTime.time_since_epoch().count())};
+}
+
+void BundleWriter::writeString(const std::string_view inString)
+{
+	write(static_cast<uint32_t>(inString.size()));
+	content.append(inString);
+}
+
+void BundleWriter::writeSymbol(const Symbol inSymbol)
+{
+	write(inSymbol.getId());
+}
+
+void BundleWriter::save(const std::string& inPath, const std::vector<std::pair<std::string, FileStamp> >& inSources) const
+{
+	if(const auto directory = std::filesystem::path(inPath).parent_path(); !directory.empty() && !std::filesystem::exists(directory))
+	{
+		std::filesystem::create_directories(directory);
+	}
+
+	BundleWriter header;
+	header.write(static_cast<uint32_t>(inSources.size()));
+	for(const auto& [sourcePath, sourceStamp] : inSources)
+	{
+		header.writeString(sourcePath);
+		header.write(sourceStamp.size);
+		header.write(sourceStamp.writeTime);
+	}
+
+	const auto* symbolTable = SymbolTable::getInstance();
+	const auto symbolCount = symbolTable->getSymbolCount();
+	header.write(symbolCount);
+	for(uint32_t symbolId = 0; symbolId < symbolCount; ++symbolId)
+	{
+		header.writeString(symbolTable->getString(symbolId));
+	}
+
+	BundleWriter preamble;
+	preamble.content.append(MAGIC, sizeof(MAGIC));
+	preamble.write(VERSION);
+	preamble.write(computeChecksum(content, computeChecksum(header.content)));
+
+	const auto temporaryPath = inPath + ".tmp";
+	{
+		std::ofstream file(temporaryPath, std::ios::out | std::ios::binary | std::ios::trunc);
+		assert(file);
+		file.write(preamble.content.data(), static_cast<std::streamsize>(preamble.content.size()));
+		file.write(header.content.data(), static_cast<std::streamsize>(header.content.size()));
+		file.write(content.data(), static_cast<std::streamsize>(content.size()));
+	}
+	std::error_code error;
+	std::filesystem::rename(temporaryPath, inPath, error); //Fails if another process has the bundle mapped on Windows, it is written again by a later run
+	if(error)
+	{
+		std::filesystem::remove(temporaryPath, error);
+	}
+}
+
+BundleReader::~BundleReader()
+{
+	close();
+}
+
+bool BundleReader::open(const std::string& inPath)
+{
+	close();
+
+#ifdef _WIN32
+	const auto file = CreateFileA(inPath.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if(file == INVALID_HANDLE_VALUE)
+	{
+		return false;
+	}
+	LARGE_INTEGER fileSize;
+	if(GetFileSizeEx(file, &fileSize) && fileSize.QuadPart > 0)
+	{
+		if(const auto mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr))
+		{
+			data = static_cast<const char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+			size = data ? static_cast<size_t>(fileSize.QuadPart) : 0;
+			CloseHandle(mapping); //The view keeps the mapping alive
+		}
+	}
+	CloseHandle(file);
+#else
+	const auto file = ::open(inPath.c_str(), O_RDONLY);
+	if(file < 0)
+	{
+		return false;
+	}
+	struct stat fileStatus{};
+	if(fstat(file, &fileStatus) == 0 && fileStatus.st_size > 0)
+	{
+		if(auto* mapping = mmap(nullptr, static_cast<size_t>(fileStatus.st_size), PROT_READ, MAP_SHARED, file, 0); mapping != MAP_FAILED)
+		{
+			data = static_cast<const char*>(mapping);
+			size = static_cast<size_t>(fileStatus.st_size);
+		}
+	}
+	::close(file); //The mapping keeps the file alive
+#endif
+	if(!data)
+	{
+		return false;
+	}
+	cursor = data;
+
+	//Every check is bounded, a truncated, corrupt or foreign file is rejected rather than read
+	if(!canRead(sizeof(MAGIC)) || std::memcmp(cursor, MAGIC, sizeof(MAGIC)) != 0)
+	{
+		close();
+		return false;
+	}
+	cursor += sizeof(MAGIC);
+	if(read<uint32_t>() != BundleWriter::VERSION)
+	{
+		close();
+		return false;
+	}
+	if(const auto checksum = read<uint64_t>(); bHasFailed || checksum != computeChecksum({cursor, static_cast<size_t>(data + size - cursor)}))
+	{
+		close();
+		return false;
+	}
+
+	const auto sourceCount = readCount(sizeof(uint32_t) + sizeof(uint64_t) + sizeof(int64_t));
+	for(uint32_t sourceIndex = 0; sourceIndex < sourceCount; ++sourceIndex)
+	{
+		const auto sourcePath = std::string(readString());
+		FileStamp sourceStamp;
+		sourceStamp.size = read<uint64_t>();
+		sourceStamp.writeTime = read<int64_t>();
+		if(bHasFailed || FileStamp::read(sourcePath) != sourceStamp)
+		{
+			close();
+			return false;
+		}
+	}
+
+	const auto symbolCount = readCount(sizeof(uint32_t));
+	symbols.reserve(symbolCount);
+	for(uint32_t symbolId = 0; symbolId < symbolCount; ++symbolId)
+	{
+		symbols.emplace_back(readString());
+	}
+	if(bHasFailed)
+	{
+		close();
+		return false;
+	}
+	return true;
+}
+
+std::string_view BundleReader::readString()
+{
+	if(bHasFailed || !canReadString())
+	{
+		bHasFailed = true;
+		return {};
+	}
+	const auto stringLength = read<uint32_t>();
+	const std::string_view result(cursor, stringLength);
+	cursor += stringLength;
+	return result;
+}
+
+Symbol BundleReader::readSymbol()
+{
+	const auto symbolId = read<uint32_t>();
+	if(symbolId >= symbols.size())
+	{
+		bHasFailed = true;
+		return {};
+	}
+	return symbols[symbolId];
+}
+
+uint32_t BundleReader::readCount(const size_t inElementSize)
+{
+	const auto count = read<uint32_t>();
+	if(!canRead(count * inElementSize))
+	{
+		bHasFailed = true;
+		return 0;
+	}
+	return count;
+}
+
+void BundleReader::fail()
+{
+	bHasFailed = true;
+}
+
+bool BundleReader::hasFailed() const
+{
+	return bHasFailed;
+}
+
+bool BundleReader::isAtEnd() const
+{
+	return cursor == data + size;
+}
+
+bool BundleReader::canRead(const size_t inSize) const
+{
+	return static_cast<size_t>(data + size - cursor) >= inSize;
+}
+
+bool BundleReader::canReadString() const
+{
+	if(!canRead(sizeof(uint32_t)))
+	{
+		return false;
+	}
+	uint32_t stringLength;
+	std::memcpy(&stringLength, cursor, sizeof(uint32_t));
+	return canRead(sizeof(uint32_t) + stringLength);
+}
+
+void BundleReader::close()
+{
+	if(data)
+	{
+#ifdef _WIN32
+		UnmapViewOfFile(data);
+#else
+		munmap(const_cast<char*>(data), size);
+#endif
+	}
+	data = nullptr;
+	size = 0;
+	cursor = nullptr;
+	symbols.clear();
+	bHasFailed = false;
+}
@@ -0,0 +1,52 @@
+#include "Cast.h"
+
+#include "DataManager.h"
+
+Cast::Cast()
+{
+	nodesIndexes.fill(NONE);
+}
+
+bool Cast::contains(const int inRoleSlot) const
+{
+	return nodesIndexes[inRoleSlot] != NONE;
+}
+
+int Cast::getNodeIndex(const int inRoleSlot) const
+{
+	assert(contains(inRoleSlot));
+	return nodesIndexes[inRoleSlot];
+}
+
+const Node* Cast::getNode(const int inRoleSlot) const
+{
+	return DataManager::getInstance()->getWorldGraph().getNodeByIndex(getNodeIndex(inRoleSlot));
+}
+
+void Cast::setNodeIndex(const int inRoleSlot, const int inNodeIndex)
+{
+	nodesIndexes[inRoleSlot] = inNodeIndex;
+}
+
+RoleTable::RoleTable()
+{
+	slots.emplace("Player", PLAYER_SLOT);
+	rolesNames.emplace_back("Player");
+}
+
+int RoleTable::getSlot(const Symbol inRoleName)
+{
+	const auto [slot, bInserted] = slots.emplace(inRoleName, static_cast<int>(slots.size()));
+	if(bInserted)
+	{
+		rolesNames.emplace_back(inRoleName);
+	}
+	assert(slot->second < Cast::MAX_ROLE_COUNT);
+	return slot->second;
+}
+
+Symbol RoleTable::getRoleName(const int inRoleSlot) const
+{
+	assert(inRoleSlot >= 0 && inRoleSlot < static_cast<int>(rolesNames.size()));
+	return rolesNames[inRoleSlot];
+}
@@ -1,26 +1,56 @@
 #include "CommandsDeclaration.h"
 
 #include "CommandsRegistry.h"
+#include "DataManager.h"
 
 void declareCommands()
 {
 	const auto* commandRegistry = CommandRegistry::getInstance();
 
-	auto changeAffinityTowardTarget = [](const std::shared_ptr<Node> inCaller, const std::list<std::string>& inRequiredRelations, const std::shared_ptr<Node> inTarget, const std::string& inNewRelationName, const std::string& inTemplatedReason) -> ConditionsBlock  // NOLINT(performance-unnecessary-value-param)
+	//Commands read the world graph through its snapshot, the conditions they produce still refer to world nodes
+	auto getWorldSourceNodeFromIncomingEdgeWithAttribute = [](const Node* inNode, const std::pair<Symbol, Symbol>& inAttribute) -> const Node*
+	{
+		const auto sourceNodeIndex = inNode ? DataManager::getInstance()->getWorldSnapshot().findSourceNodeFromIncomingEdgeWithAttribute(inNode->getIndex(), inAttribute) : NONE;
+		return sourceNodeIndex != NONE ? DataManager::getInstance()->getWorldGraph().getNodeByIndex(sourceNodeIndex) : nullptr;
+	};
+
+	auto getWorldTargetNodeFromOutgoingEdgeWithAttribute = [](const Node* inNode, const std::pair<Symbol, Symbol>& inAttribute) -> const Node*
+	{
+		const auto targetNodeIndex = inNode ? DataManager::getInstance()->getWorldSnapshot().findTargetNodeFromOutgoingEdgeWithAttribute(inNode->getIndex(), inAttribute) : NONE;
+		return targetNodeIndex != NONE ? DataManager::getInstance()->getWorldGraph().getNodeByIndex(targetNodeIndex) : nullptr;
+	};
+
+	//Symbols interned once for all the conditions the commands produce
+	const std::vector<Symbol> friendlyRelations{"Loves", "Friends"};
+	const std::vector<Symbol> hostileRelations{"Hates", "Enemies"};
+	const std::pair<Symbol, Symbol> livesAttribute{"Lives", "N/A"};
+	const std::pair<Symbol, Symbol> ownsAttribute{"Owns", "N/A"};
+	const EdgeAttributes currentlyInAttributes{{"Currently_In", "N/A"}};
+	const Symbol hatesRelation("Hates");
+	const Symbol friendsRelation("Friends");
+	const Symbol ownsRelation("Owns");
+	const Symbol numberAttributeName("number");
+	const Symbol statusAttributeName("status");
+	const NodeAttribute noEnemyLeft("int", "0");
+
+	auto changeAffinityTowardTarget = [](const Node* inCaller, const std::vector<Symbol>& inRequiredRelations, const Node* inTarget, const Symbol inNewRelationName, const std::string& inTemplatedReason) -> ConditionsBlock
 	{	
-		const auto& reason = inTemplatedReason + inCaller->getName();
+		const Symbol reason(inTemplatedReason + inCaller->getName());
+		const auto& worldGraph = DataManager::getInstance()->getWorldGraph();
+		const auto& worldSnapshot = DataManager::getInstance()->getWorldSnapshot();
 
 		ConditionsBlock result;
-		for(const auto& edge : inCaller->getIncomingEdges())
+		for(const auto edgeIndex : worldSnapshot.getIncomingEdges(inCaller->getIndex()))
 		{
-			for(auto& requiredRelation : inRequiredRelations)
+			for(const auto requiredRelation : inRequiredRelations)
 			{
-				if(auto foundAttribute = edge->getAttributes().find<std::string>(requiredRelation); foundAttribute != edge->getAttributes().end())
+				if(const auto* foundAttribute = worldSnapshot.findEdgeAttribute(edgeIndex, requiredRelation))
 				{
-					if(const auto sourceNode = edge->getSourceNode(); !(sourceNode->getName() == inTarget->getName()))
+					if(const auto sourceNodeIndex = worldSnapshot.getEdgeSource(edgeIndex); worldSnapshot.getNodeName(sourceNodeIndex) != inTarget->getNameSymbol())
 					{
-						result.preConditions.edgeConditions.emplace_back(EdgeCondition{sourceNode, inCaller, {{foundAttribute->first, foundAttribute->second}}});
-						result.postConditions.edgeConditions.emplace_back(EdgeCondition{sourceNode, inTarget, {{inNewRelationName, reason}}});
+						const auto sourceNode = worldGraph.getNodeByIndex(sourceNodeIndex);
+						result.preConditions.addEdgeCondition(EdgeCondition{sourceNode, inCaller, {{foundAttribute->first, foundAttribute->second}}});
+						result.postConditions.addEdgeCondition(EdgeCondition{sourceNode, inTarget, {{inNewRelationName, reason}}});
 					}
 				}
 			}
@@ -36,17 +66,18 @@ void declareCommands()
 	 ******************************************************************************/
 	commandRegistry->registerCommand("murder", new Command
 	{
-		[](const std::unordered_map<std::string, std::shared_ptr<Node> >& inCast, const CommandData& inCommandData)
+		{CommandArgumentType::Role},
+		[](const Cast& inCast, const CompiledCommand& inCommand)
 		{
-			assert(inCommandData.arguments.size() == 1);
-			PRINTLN("Command: " + inCommandData.name);
-			PRINTLN(inCast.at(std::any_cast<std::string>(inCommandData.arguments[0]))->getName() + " murdered " + inCast.at(inCommandData.caller)->getName());
+			PRINTLN("Command: " + inCommand.command->name);
+			PRINTLN(inCast.getNode(inCommand.getArgument<RoleArgument>(0).slot)->getName() + " murdered " + inCast.getNode(inCommand.callerSlot)->getName());
 		},
-		[changeAffinityTowardTarget](const std::unordered_map<std::string, std::shared_ptr<Node> >& inCast, const CommandData& inCommandData) -> ConditionsBlock
+		[changeAffinityTowardTarget, friendlyRelations, hostileRelations, hatesRelation, friendsRelation](const Cast& inCast, const CompiledCommand& inCommand) -> ConditionsBlock
 		{
-			assert(inCommandData.arguments.size() == 1);
-			auto result = changeAffinityTowardTarget(inCast.at(inCommandData.caller), {"Loves","Friends"}, inCast.at(std::any_cast<std::string>(inCommandData.arguments[0])), "Hates", "Murder_of_");
-			result.append(changeAffinityTowardTarget(inCast.at(inCommandData.caller), {"Hates","Enemies"}, inCast.at(std::any_cast<std::string>(inCommandData.arguments[0])), "Friends", "Murder_of_"));
+			const auto* caller = inCast.getNode(inCommand.callerSlot);
+			const auto* murderer = inCast.getNode(inCommand.getArgument<RoleArgument>(0).slot);
+			auto result = changeAffinityTowardTarget(caller, friendlyRelations, murderer, hatesRelation, "Murder_of_");
+			result.append(changeAffinityTowardTarget(caller, hostileRelations, murderer, friendsRelation, "Murder_of_"));
 			return result;
 		}
 	});
@@ -58,15 +89,14 @@ void declareCommands()
 	 ******************************************************************************/
 	commandRegistry->registerCommand("die", new Command
 	{
-		[](const std::unordered_map<std::string, std::shared_ptr<Node> >& inCast, const CommandData& inCommandData)
+		{},
+		[](const Cast& inCast, const CompiledCommand& inCommand)
 		{
-			assert(inCommandData.arguments.empty());			
-			PRINTLN("Command: " + inCommandData.name);
-			PRINTLN(inCast.at(inCommandData.caller)->getName() + " died");
+			PRINTLN("Command: " + inCommand.command->name);
+			PRINTLN(inCast.getNode(inCommand.callerSlot)->getName() + " died");
 		},
-		[](const std::unordered_map<std::string, std::shared_ptr<Node> >& inCast, const CommandData& inCommandData) -> ConditionsBlock
+		[](const Cast& inCast, const CompiledCommand& inCommand) -> ConditionsBlock
 		{
-			assert(inCommandData.arguments.empty());
 			return{};
 		}
 	});
@@ -82,27 +112,20 @@ void declareCommands()
 	 ******************************************************************************/
 	commandRegistry->registerCommand("set_other_nodes_relations", new Command
 	{
-		[](const std::unordered_map<std::string, std::shared_ptr<Node> >& inCast, const CommandData& inCommandData)
+		{CommandArgumentType::Symbols, CommandArgumentType::Symbol, CommandArgumentType::Role, CommandArgumentType::Symbol},
+		[](const Cast& inCast, const CompiledCommand& inCommand)
 		{
-			assert(inCommandData.arguments.size() == 4);
-
-			const auto callerName = inCast.at(inCommandData.caller)->getName();
-			PRINTLN("Command: " + inCommandData.name);
+			const auto callerName = inCast.getNode(inCommand.callerSlot)->getName();
+			PRINTLN("Command: " + inCommand.command->name);
 			PRINTLN("People whom had the following relationship with " + callerName + ":");
-			const auto& edgeAttribute = std::any_cast<std::vector<std::any> >(inCommandData.arguments[0]);
+			const auto& edgeAttribute = inCommand.getArgument<std::vector<Symbol> >(0);
 			assert(edgeAttribute.size() == 2);
-			PRINTLN("\t- " + std::any_cast<std::string>(edgeAttribute[0]) + " : " + std::any_cast<std::string>(edgeAttribute[1]));
-			PRINTLN("Now have the relationship \"" + std::any_cast<std::string>(inCommandData.arguments[1]) + "\" with " + inCast.at(std::any_cast<std::string>(inCommandData.arguments[2]))->getName() + " because of " + std::any_cast<std::string>(inCommandData.arguments[3]) + callerName);
+			PRINTLN("\t- " + edgeAttribute[0].getString() + " : " + edgeAttribute[1].getString());
+			PRINTLN("Now have the relationship \"" + inCommand.getArgument<Symbol>(1).getString() + "\" with " + inCast.getNode(inCommand.getArgument<RoleArgument>(2).slot)->getName() + " because of " + inCommand.getArgument<Symbol>(3).getString() + callerName);
 		},
-		[changeAffinityTowardTarget](const std::unordered_map<std::string, std::shared_ptr<Node> >& inCast, const CommandData& inCommandData) -> ConditionsBlock
+		[changeAffinityTowardTarget](const Cast& inCast, const CompiledCommand& inCommand) -> ConditionsBlock
 		{
-			assert(inCommandData.arguments.size() == 4);
-			std::list<std::string> requiredRelations;
-			for(auto& element : std::any_cast<std::vector<std::any> >(inCommandData.arguments[0]))
-			{
-				requiredRelations.emplace_back(std::any_cast<std::string>(element));
-			}
-			return changeAffinityTowardTarget(inCast.at(inCommandData.caller), requiredRelations, inCast.at(std::any_cast<std::string>(inCommandData.arguments[2])), std::any_cast<std::string>(inCommandData.arguments[1]), std::any_cast<std::string>(inCommandData.arguments[3]));
+			return changeAffinityTowardTarget(inCast.getNode(inCommand.callerSlot), inCommand.getArgument<std::vector<Symbol> >(0), inCast.getNode(inCommand.getArgument<RoleArgument>(2).slot), inCommand.getArgument<Symbol>(1), inCommand.getArgument<Symbol>(3).getString());
 		}
 	});
 
@@ -114,24 +137,20 @@ void declareCommands()
 	 ******************************************************************************/
 	commandRegistry->registerCommand("move_player_to_node", new Command
 	{
-		[](const std::unordered_map<std::string, std::shared_ptr<Node> >& inCast, const CommandData& inCommandData)
+		{CommandArgumentType::Role},
+		[](const Cast& inCast, const CompiledCommand& inCommand)
 		{
-			assert(inCommandData.arguments.size() == 1);		
-			PRINTLN("Command: " + inCommandData.name);
-			PRINTLN(inCast.at(inCommandData.caller)->getName() + " moved to " + inCast.at(std::any_cast<std::string>(inCommandData.arguments[0]))->getName() + "'s location");
+			PRINTLN("Command: " + inCommand.command->name);
+			PRINTLN(inCast.getNode(inCommand.callerSlot)->getName() + " moved to " + inCast.getNode(inCommand.getArgument<RoleArgument>(0).slot)->getName() + "'s location");
 		},
-		[](const std::unordered_map<std::string, std::shared_ptr<Node> >& inCast, const CommandData& inCommandData) -> ConditionsBlock
+		[getWorldTargetNodeFromOutgoingEdgeWithAttribute, livesAttribute, currentlyInAttributes](const Cast& inCast, const CompiledCommand& inCommand) -> ConditionsBlock
 		{
-			assert(inCommandData.arguments.size() == 1);
-
-
-
 			return
 			{
 				{},
 				{
 					{},
-				{EdgeCondition{inCast.at(inCommandData.caller), inCast.at(std::any_cast<std::string>(inCommandData.arguments[0]))->getTargetNodeFromOutgoingEdgeWithAttribute({"Lives", "N/A"}), {{"Currently_In", "N/A"}}}}
+					{EdgeCondition{inCast.getNode(inCommand.callerSlot), getWorldTargetNodeFromOutgoingEdgeWithAttribute(inCast.getNode(inCommand.getArgument<RoleArgument>(0).slot), livesAttribute), currentlyInAttributes}}
 				}
 			};
 		}
@@ -145,25 +164,23 @@ void declareCommands()
 	 ******************************************************************************/
 	commandRegistry->registerCommand("killed_enemy", new Command
 	{
-		[](const std::unordered_map<std::string, std::shared_ptr<Node> >& inCast, const CommandData& inCommandData)
+		{CommandArgumentType::Role},
+		[](const Cast& inCast, const CompiledCommand& inCommand)
 		{
-			assert(inCommandData.arguments.size() == 1);			
-			PRINTLN("Command: " + inCommandData.name);
-			PRINTLN(inCast.at(inCommandData.caller)->getName() + " killed " + inCast.at(std::any_cast<std::string>(inCommandData.arguments[0]))->getName());
+			PRINTLN("Command: " + inCommand.command->name);
+			PRINTLN(inCast.getNode(inCommand.callerSlot)->getName() + " killed " + inCast.getNode(inCommand.getArgument<RoleArgument>(0).slot)->getName());
 		},
-		[](const std::unordered_map<std::string, std::shared_ptr<Node> >& inCast, const CommandData& inCommandData) -> ConditionsBlock
+		[numberAttributeName, noEnemyLeft](const Cast& inCast, const CompiledCommand& inCommand) -> ConditionsBlock
 		{
-			assert(inCommandData.arguments.size() == 1);
-
-			const auto enemy = inCast.at(std::any_cast<std::string>(inCommandData.arguments[0]));
+			const auto enemy = inCast.getNode(inCommand.getArgument<RoleArgument>(0).slot);
 			return
 			{
 				{
-					{NodeCondition{enemy, "number", "0", ComparisonType::Greater}},
+					{NodeCondition{enemy, numberAttributeName, noEnemyLeft, ComparisonType::Greater}},
 					{}
 				},
 				{
-					{NodeCondition{enemy, "number", "0", ComparisonType::Equal}},
+					{NodeCondition{enemy, numberAttributeName, noEnemyLeft, ComparisonType::Equal}},
 					{}
 				}
 
@@ -181,29 +198,27 @@ void declareCommands()
 	 ******************************************************************************/
 	commandRegistry->registerCommand("new_owner", new Command
 	{
-		[](const std::unordered_map<std::string, std::shared_ptr<Node> >& inCast, const CommandData& inCommandData)
+		{CommandArgumentType::Role, CommandArgumentType::Attribute, CommandArgumentType::Symbol},
+		[](const Cast& inCast, const CompiledCommand& inCommand)
 		{
-			assert(inCommandData.arguments.size() == 3);
-			PRINTLN("Command: " + inCommandData.name);
-			PRINTLN(inCast.at(inCommandData.caller)->getName() + " is now owned by " + inCast.at(std::any_cast<std::string>(inCommandData.arguments[0]))->getName() + " and has status \""  + std::any_cast<std::string>(inCommandData.arguments[1]) + "\" because of "  + std::any_cast<std::string>(inCommandData.arguments[2]));
+			PRINTLN("Command: " + inCommand.command->name);
+			PRINTLN(inCast.getNode(inCommand.callerSlot)->getName() + " is now owned by " + inCast.getNode(inCommand.getArgument<RoleArgument>(0).slot)->getName() + " and has status \""  + inCommand.getArgument<NodeAttribute>(1).getText().getString() + "\" because of "  + inCommand.getArgument<Symbol>(2).getString());
 		},
-		[](const std::unordered_map<std::string, std::shared_ptr<Node> >& inCast, const CommandData& inCommandData) -> ConditionsBlock
+		[getWorldSourceNodeFromIncomingEdgeWithAttribute, getWorldTargetNodeFromOutgoingEdgeWithAttribute, ownsAttribute, livesAttribute, currentlyInAttributes, statusAttributeName, ownsRelation](const Cast& inCast, const CompiledCommand& inCommand) -> ConditionsBlock
 		{
-			assert(inCommandData.arguments.size() == 3);
-
-			const auto& caller = inCast.at(inCommandData.caller);
-			const auto previousOwner = caller->getSourceNodeFromIncomingEdgeWithAttribute({"Owns", "N/A"});
-			const auto previousLocation = previousOwner->getTargetNodeFromOutgoingEdgeWithAttribute({"Lives", "N/A"});
+			const auto& caller = inCast.getNode(inCommand.callerSlot);
+			const auto previousOwner = getWorldSourceNodeFromIncomingEdgeWithAttribute(caller, ownsAttribute);
+			const auto previousLocation = getWorldTargetNodeFromOutgoingEdgeWithAttribute(previousOwner, livesAttribute);
 
 			return
 			{
 				{
 					{},
-					{EdgeCondition{caller, previousLocation, {{"Currently_In", "N/A"}}}}
+					{EdgeCondition{caller, previousLocation, currentlyInAttributes}}
 				},
 				{
-					{NodeCondition{caller, "status", std::any_cast<std::string>(inCommandData.arguments[1]), ComparisonType::Equal}},
-					{EdgeCondition{inCast.at(std::any_cast<std::string>(inCommandData.arguments[0])), caller, {{"Owns", std::any_cast<std::string>(inCommandData.arguments[2])}}}}
+					{NodeCondition{caller, statusAttributeName, inCommand.getArgument<NodeAttribute>(1), ComparisonType::Equal}},
+					{EdgeCondition{inCast.getNode(inCommand.getArgument<RoleArgument>(0).slot), caller, {{ownsRelation, inCommand.getArgument<Symbol>(2)}}}}
 				}
 			};
 		}
@@ -219,21 +234,20 @@ void declareCommands()
 	 ******************************************************************************/
 	commandRegistry->registerCommand("add_edge", new Command
 	{
-		[](const std::unordered_map<std::string, std::shared_ptr<Node> >& inCast, const CommandData& inCommandData)
+		{CommandArgumentType::Role, CommandArgumentType::Symbol, CommandArgumentType::Symbol},
+		[](const Cast& inCast, const CompiledCommand& inCommand)
 		{
-			assert(inCommandData.arguments.size() == 3);
-			PRINTLN("Command: " + inCommandData.name);
-			PRINTLN(inCast.at(inCommandData.caller)->getName() + " now has \"" + std::any_cast<std::string>(inCommandData.arguments[1]) + "\" relationship with " + inCast.at(std::any_cast<std::string>(inCommandData.arguments[0]))->getName() + " because of " + std::any_cast<std::string>(inCommandData.arguments[2]));
+			PRINTLN("Command: " + inCommand.command->name);
+			PRINTLN(inCast.getNode(inCommand.callerSlot)->getName() + " now has \"" + inCommand.getArgument<Symbol>(1).getString() + "\" relationship with " + inCast.getNode(inCommand.getArgument<RoleArgument>(0).slot)->getName() + " because of " + inCommand.getArgument<Symbol>(2).getString());
 		},
-		[](const std::unordered_map<std::string, std::shared_ptr<Node> >& inCast, const CommandData& inCommandData) -> ConditionsBlock
+		[](const Cast& inCast, const CompiledCommand& inCommand) -> ConditionsBlock
 		{
-			assert(inCommandData.arguments.size() == 3);
 			return
 			{
 				{},
 				{
 					{},
-					{EdgeCondition{inCast.at(inCommandData.caller), inCast.at(std::any_cast<std::string>(inCommandData.arguments[0])), {{std::any_cast<std::string>(inCommandData.arguments[1]), std::any_cast<std::string>(inCommandData.arguments[2])}}}}
+					{EdgeCondition{inCast.getNode(inCommand.callerSlot), inCast.getNode(inCommand.getArgument<RoleArgument>(0).slot), {{inCommand.getArgument<Symbol>(1), inCommand.getArgument<Symbol>(2)}}}}
 				}
 
 			};
@@ -245,24 +259,23 @@ void declareCommands()
 	 *
 	 * @caller ref entity
 	 * @param string attributeName
-	 * @param string attributeValue
+	 * @param attribute attributeValue
 	 ******************************************************************************/
 	commandRegistry->registerCommand("modify_attribute", new Command
 	{
-		[](const std::unordered_map<std::string, std::shared_ptr<Node> >& inCast, const CommandData& inCommandData)
+		{CommandArgumentType::Symbol, CommandArgumentType::Attribute},
+		[](const Cast& inCast, const CompiledCommand& inCommand)
 		{
-			assert(inCommandData.arguments.size() == 2);
-			PRINTLN("Command: " + inCommandData.name);
-			PRINTLN(inCast.at(inCommandData.caller)->getName() + "'s \"" + std::any_cast<std::string>(inCommandData.arguments[0]) + "\" attribute is now equal to " + std::any_cast<std::string>(inCommandData.arguments[1]));
+			PRINTLN("Command: " + inCommand.command->name);
+			PRINTLN(inCast.getNode(inCommand.callerSlot)->getName() + "'s \"" + inCommand.getArgument<Symbol>(0).getString() + "\" attribute is now equal to " + inCommand.getArgument<NodeAttribute>(1).getText().getString());
 		},
-		[](const std::unordered_map<std::string, std::shared_ptr<Node> >& inCast, const CommandData& inCommandData) -> ConditionsBlock
+		[](const Cast& inCast, const CompiledCommand& inCommand) -> ConditionsBlock
 		{
-			assert(inCommandData.arguments.size() == 2);
 			return
 			{
 				{},
 				{
-					{NodeCondition{inCast.at(inCommandData.caller), std::any_cast<std::string>(inCommandData.arguments[0]), std::any_cast<std::string>(inCommandData.arguments[1]), ComparisonType::Equal}},
+					{NodeCondition{inCast.getNode(inCommand.callerSlot), inCommand.getArgument<Symbol>(0), inCommand.getArgument<NodeAttribute>(1), ComparisonType::Equal}},
 					{}
 				}
 			};
@@ -4,20 +4,69 @@ void CommandRegistry::registerCommand(const std::string& inKey, Command* inObjec
 {	
 	if (commands.find(inKey) == commands.end())
 	{
+		inObject->name = inKey;
 		commands[inKey] = inObject;
 		return;
 	}
 	assert(false);	
 }
 
-void CommandRegistry::executeCommand(const std::unordered_map<std::string, std::shared_ptr<Node>>& inCast, const CommandData& inCommandData) const
+CompiledCommand CommandRegistry::compileCommand(const CommandData& inCommandData) const
 {
-	find(inCommandData.name)->implementation(inCast, inCommandData);
+	auto* roleTable = RoleTable::getInstance();
+	CompiledCommand result{find(inCommandData.name), roleTable->getSlot(inCommandData.caller), {}};
+	const auto& signature = result.command->signature;
+	assert(inCommandData.arguments.size() == signature.size());
+	result.arguments.reserve(signature.size());
+	for(size_t argumentPosition = 0; argumentPosition < signature.size(); ++argumentPosition)
+	{
+		const auto& argument = inCommandData.arguments[argumentPosition];
+		switch(signature[argumentPosition])
+		{
+			case CommandArgumentType::Role:
+				result.arguments.emplace_back(RoleArgument{roleTable->getSlot(std::any_cast<std::string>(argument))});
+				break;
+			case CommandArgumentType::Symbol:
+				result.arguments.emplace_back(Symbol(std::any_cast<std::string>(argument)));
+				break;
+			case CommandArgumentType::Symbols:
+			{
+				std::vector<Symbol> symbols;
+				for(const auto& element : std::any_cast<std::vector<std::any> >(argument))
+				{
+					symbols.emplace_back(std::any_cast<std::string>(element));
+				}
+				result.arguments.emplace_back(std::move(symbols));
+				break;
+			}
+			case CommandArgumentType::Attribute: //Untyped values are strings
+				if(const auto* attribute = std::any_cast<NodeAttribute>(&argument))
+				{
+					result.arguments.emplace_back(*attribute);
+				}
+				else
+				{
+					result.arguments.emplace_back(NodeAttribute("str", std::any_cast<std::string>(argument)));
+				}
+				break;
+		}
+	}
+	return result;
+}
+
+const Command* CommandRegistry::getCommand(const std::string& inName) const
+{
+	return find(inName);
+}
+
+void CommandRegistry::executeCommand(const Cast& inCast, const CompiledCommand& inCommand)
+{
+	inCommand.command->implementation(inCast, inCommand);
 }
 
-ConditionsBlock CommandRegistry::getCommandConditions(const std::unordered_map<std::string, std::shared_ptr<Node>>& inCast, const CommandData& inCommandData) const
+ConditionsBlock CommandRegistry::getCommandConditions(const Cast& inCast, const CompiledCommand& inCommand)
 {
-	return find(inCommandData.name)->conditionConstructor(inCast, inCommandData);
+	return inCommand.command->conditionConstructor(inCast, inCommand);
 }
 
 Command* CommandRegistry::find(const std::string& inKey) const
@@ -1,10 +1,13 @@
 #include "Conditions.h"
 
+uint64_t NodeCondition::getKey() const
+{
+	return static_cast<uint64_t>(static_cast<uint32_t>(node->getIndex())) << 32 | attributeName.getId();
+}
+
 bool NodeCondition::conflicts(const NodeCondition& inNodeCondition) const
 {
-	return node->getName() == inNodeCondition.node->getName()
-		&& attributeName == inNodeCondition.attributeName
-		&& !compares(inNodeCondition);
+	return getKey() == inNodeCondition.getKey() && !compares(inNodeCondition);
 }
 
 bool NodeCondition::compares(const NodeCondition& inNodeCondition) const
@@ -14,9 +17,9 @@ bool NodeCondition::compares(const NodeCondition& inNodeCondition) const
 		case ComparisonType::Equal:
 			return inNodeCondition.attributeValue == attributeValue;
 		case ComparisonType::Greater:
-			return std::stoi(inNodeCondition.attributeValue) > std::stoi(attributeValue);
+			return inNodeCondition.attributeValue > attributeValue;
 		case ComparisonType::Lesser:
-			return std::stoi(inNodeCondition.attributeValue) < std::stoi(attributeValue);
+			return inNodeCondition.attributeValue < attributeValue;
 	}
 	return false;
 }
@@ -37,44 +40,158 @@ void NodeCondition::print() const
 			comparisonString = "<";
 			break;
 	}
-	PRINTLN(node->getName() + "_" + attributeName + "_" + comparisonString + "_" + attributeValue);
+	PRINTLN(node->getName() + "_" + attributeName.getString() + "_" + comparisonString + "_" + attributeValue.getText().getString());
 }
 #endif
 
-EdgeCondition::EdgeCondition(const std::shared_ptr<Node>& inSourceNode, const std::shared_ptr<Node>& inTargetNode, const std::unordered_map<std::string, std::string> & inAttributes) : Edge(inSourceNode, inTargetNode, inAttributes)
+EdgeCondition::EdgeCondition(const Node* inSourceNode, const Node* inTargetNode, EdgeAttributes inAttributes) : sourceNode(inSourceNode), targetNode(inTargetNode), attributes(std::move(inAttributes))
+{
+}
+
+const Node* EdgeCondition::getSourceNode() const
+{
+	return sourceNode;
+}
+
+const Node* EdgeCondition::getTargetNode() const
+{
+	return targetNode;
+}
+
+const EdgeAttributes& EdgeCondition::getAttributes() const
 {
+	return attributes;
+}
+
+bool EdgeCondition::hasNodes() const
+{
+	return sourceNode && targetNode;
+}
+
+uint64_t EdgeCondition::getKey() const
+{
+	assert(hasNodes());
+	return static_cast<uint64_t>(static_cast<uint32_t>(sourceNode->getIndex())) << 32 | static_cast<uint32_t>(targetNode->getIndex());
 }
 
 bool EdgeCondition::conflicts(const EdgeCondition& inEdgeCondition) const
 {
-	return getSourceNode()->getName() == inEdgeCondition.getSourceNode()->getName()
-		&& getTargetNode()->getName() == inEdgeCondition.getTargetNode()->getName()
-		&& getAttributes().begin()->first != inEdgeCondition.getAttributes().begin()->first;
+	return hasNodes() && inEdgeCondition.hasNodes() && getKey() == inEdgeCondition.getKey() && getAttributes().begin()->first != inEdgeCondition.getAttributes().begin()->first;
+}
+
+#ifndef NDEBUG
+void EdgeCondition::print() const
+{
+	const auto& sourceName = sourceNode ? sourceNode->getName() : Symbols::NOT_AVAILABLE.getString();
+	const auto& targetName = targetNode ? targetNode->getName() : Symbols::NOT_AVAILABLE.getString();
+	for(const auto& [attributeName, attributeValue] : attributes)
+	{
+		PRINTLN(sourceName + "_" + attributeName.getString() + "_" + attributeValue.getString() + "_" + targetName);
+	}
+}
+#endif
+
+Conditions::Conditions(const std::initializer_list<NodeCondition> inNodeConditions, const std::initializer_list<EdgeCondition> inEdgeConditions)
+{
+	for(const auto& nodeCondition : inNodeConditions)
+	{
+		addNodeCondition(nodeCondition);
+	}
+	for(const auto& edgeCondition : inEdgeConditions)
+	{
+		addEdgeCondition(edgeCondition);
+	}
+}
+
+const std::vector<NodeCondition>& Conditions::getNodeConditions() const
+{
+	return nodeConditions;
+}
+
+const std::vector<EdgeCondition>& Conditions::getEdgeConditions() const
+{
+	return edgeConditions;
+}
+
+void Conditions::addNodeCondition(const NodeCondition& inNodeCondition)
+{
+	nodeConditionsByKey[inNodeCondition.getKey()].emplace_back(static_cast<int>(nodeConditions.size()));
+	nodeConditions.emplace_back(inNodeCondition);
+}
+
+void Conditions::addEdgeCondition(EdgeCondition inEdgeCondition)
+{
+	if(inEdgeCondition.hasNodes())
+	{
+		edgeConditionsByKey[inEdgeCondition.getKey()].emplace_back(static_cast<int>(edgeConditions.size()));
+	}
+	edgeConditions.emplace_back(std::move(inEdgeCondition));
 }
 
-bool Conditions::conflicts(const Conditions& inCondition)
+bool Conditions::conflicts(const Conditions& inConditions) const
 {
-	return
-		std::ranges::any_of(nodeConditions, [inCondition](const NodeCondition& inNodeCondition)
+	for(const auto& nodeCondition : nodeConditions)
+	{
+		if(const auto otherNodeConditions = inConditions.nodeConditionsByKey.find(nodeCondition.getKey()); otherNodeConditions != inConditions.nodeConditionsByKey.end())
 		{
-			return std::ranges::any_of(inCondition.nodeConditions, [inNodeCondition](const NodeCondition& inOtherNodeCondition)
+			for(const auto position : otherNodeConditions->second)
 			{
-				return inNodeCondition.conflicts(inOtherNodeCondition);
-			});
-		})
-		|| std::ranges::any_of(edgeConditions, [inCondition](const EdgeCondition& inEdgeCondition)
+				if(nodeCondition.conflicts(inConditions.nodeConditions[position]))
+				{
+					return true;
+				}
+			}
+		}
+	}
+
+	for(const auto& edgeCondition : edgeConditions)
+	{
+		if(!edgeCondition.hasNodes())
+		{
+			continue;
+		}
+		if(const auto otherEdgeConditions = inConditions.edgeConditionsByKey.find(edgeCondition.getKey()); otherEdgeConditions != inConditions.edgeConditionsByKey.end())
 		{
-			return std::ranges::any_of(inCondition.edgeConditions, [inEdgeCondition](const EdgeCondition& inOtherEdgeCondition)
+			for(const auto position : otherEdgeConditions->second)
 			{
-				return inEdgeCondition.conflicts(inOtherEdgeCondition);
-			});
-		});
+				if(edgeCondition.conflicts(inConditions.edgeConditions[position]))
+				{
+					return true;
+				}
+			}
+		}
+	}
+	return false;
 }
 
 void Conditions::append(Conditions& inConditions)
 {
-	nodeConditions.splice(nodeConditions.end(), inConditions.nodeConditions);
-	edgeConditions.splice(edgeConditions.end(), inConditions.edgeConditions);
+	//Positions of the appended conditions are shifted past the current ones
+	const auto nodeConditionsOffset = static_cast<int>(nodeConditions.size());
+	for(auto& [key, positions] : inConditions.nodeConditionsByKey)
+	{
+		auto& mergedPositions = nodeConditionsByKey[key];
+		for(const auto position : positions)
+		{
+			mergedPositions.emplace_back(nodeConditionsOffset + position);
+		}
+	}
+	const auto edgeConditionsOffset = static_cast<int>(edgeConditions.size());
+	for(auto& [key, positions] : inConditions.edgeConditionsByKey)
+	{
+		auto& mergedPositions = edgeConditionsByKey[key];
+		for(const auto position : positions)
+		{
+			mergedPositions.emplace_back(edgeConditionsOffset + position);
+		}
+	}
+	nodeConditions.insert(nodeConditions.end(), std::make_move_iterator(inConditions.nodeConditions.begin()), std::make_move_iterator(inConditions.nodeConditions.end()));
+	edgeConditions.insert(edgeConditions.end(), std::make_move_iterator(inConditions.edgeConditions.begin()), std::make_move_iterator(inConditions.edgeConditions.end()));
+
+	inConditions.nodeConditions.clear();
+	inConditions.edgeConditions.clear();
+	inConditions.nodeConditionsByKey.clear();
+	inConditions.edgeConditionsByKey.clear();
 }
 
 #ifndef NDEBUG
@@ -1,24 +1,192 @@
 #include "DataManager.h"
 
 #include <filesystem>
+#include <fstream>
+#include <random>
 #include <pugixml.hpp>
 
-#ifndef NDEBUG
+#include "Bundle.h"
 #include "CommandsRegistry.h"
-#endif
+#include "MatchCache.h"
+#include "OutputPipeline.h"
+#include "ThreadPool.h"
 
 constexpr auto FILE_EXTENSION = ".xml";
+constexpr auto INITIALIZATION_RULES_FOLDER = "Rules/InitializationRules/";
+constexpr auto REWRITE_RULES_FOLDER = "Rules/RewriteRules/";
+
+struct DataManager::ParsedRuleFiles
+{
+	pugi::xml_document attributes;
+	pugi::xml_document socialConditions;
+	pugi::xml_document storyConditions; //Empty if the rule has no story conditions
+	pugi::xml_document storyGraph;
+	std::unordered_map<std::string, std::string> modificationsContents; //By file name
+	Sources sources; //Every file the rule is read from, optional ones included
+};
+
+bool DataManager::init(const char* inTestLayoutName, const char* inContentPath)
+{
+	contentPath = inContentPath;
+	testLayoutName = inTestLayoutName;
+	matchCachePath = contentPath + "Cache/" + testLayoutName + ".matches";
+	bundlePath = contentPath + "Cache/" + testLayoutName + ".bundle";
+
+	//The bundle written by a previous run replaces the XML sources as long as none of them changed since
+	if(!loadBundle(bundlePath))
+	{
+		if(!loadSources()) //Neither cached nor generated from
+		{
+			return false;
+		}
+		saveBundle(bundlePath);
+	}
+	chooseSeed();
+	worldGraph.createSnapshot();
+	compileMatchPlans(getRules());
+	return true;
+}
+
+bool DataManager::reload()
+{
+	auto* matchCache = MatchCache::getInstance();
+	if(testLayoutSources.haveChanged()) //The layout decides of everything else, it is loaded again whole
+	{
+		matchCache->forget(worldGraph);
+		clearData();
+		const auto bHasLoadedSources = loadSources();
+		forgetUnusedModifications();
+		chooseSeed();
+		worldGraph.createSnapshot();
+		compileMatchPlans(getRules());
+		if(bHasLoadedSources)
+		{
+			saveBundle(bundlePath);
+		}
+		return bHasLoadedSources;
+	}
+
+	//A world graph that can't be read is reported and the previous one kept, its sources are still brought up to date so that it is only read again once fixed
+	auto bWorldGraphChanged = false;
+	auto bHasFailed = false;
+	if(worldGraphSources.haveChanged())
+	{
+		const auto worldGraphPath = worldGraphSources.files.front().first;
+		worldGraphSources = Sources();
+		bWorldGraphChanged = loadWorldGraph(worldGraphPath);
+		bHasFailed = !bWorldGraphChanged;
+		if(bWorldGraphChanged)
+		{
+			matchCache->forget(worldGraph);
+			worldGraph.createSnapshot();
+		}
+	}
+
+	//Changed rules are parsed concurrently, then rebuilt in place in listing order so that the other rules and their cached mappings stay as they are
+	auto* threadPool = ThreadPool::getInstance();
+	const auto rulesParsing = threadPool->createTaskGroup();
+	std::vector<std::pair<Rule*, std::future<std::unique_ptr<ParsedRuleFiles> > > > changedRulesFiles;
+	for(const auto& [rules, rulesPath] : {std::pair{&initializationRules, contentPath + INITIALIZATION_RULES_FOLDER}, std::pair{&rewriteRules, contentPath + REWRITE_RULES_FOLDER}})
+	{
+		for(auto& rule : *rules)
+		{
+			if(rulesSources.at(&rule).haveChanged())
+			{
+				changedRulesFiles.emplace_back(&rule, threadPool->submit(rulesParsing, [ruleFolderPath = rulesPath + rule.name + "/", ruleName = rule.name]()
+				{
+					return parseRuleFiles(ruleFolderPath, ruleName);
+				}));
+			}
+		}
+	}
+
+	const auto noModification = std::make_shared<const std::vector<CompiledCommand> >();
+	std::vector<Rule*> changedRules;
+	changedRules.reserve(changedRulesFiles.size());
+	for(auto& [rule, ruleFiles] : changedRulesFiles)
+	{
+		const auto files = threadPool->wait(rulesParsing, ruleFiles);
+		matchCache->forget(rule->socialConditions);
+		auto ruleName = std::move(rule->name);
+		*rule = Rule();
+		buildRule(std::move(ruleName), *files, noModification, *rule);
+		changedRules.emplace_back(rule);
+	}
 
-void DataManager::init(const char* inTestLayoutName, const char* inContentPath)
+	if(!bWorldGraphChanged && changedRules.empty())
+	{
+		return false;
+	}
+	forgetUnusedModifications();
+	compileMatchPlans(bWorldGraphChanged ? getRules() : changedRules); //Social conditions are planned from the statistics of the world graph
+	if(!bHasFailed) //The bundle would hold the previous world graph under the stamp of the file that couldn't be read
+	{
+		saveBundle(bundlePath);
+	}
+	return true;
+}
+
+void DataManager::Sources::add(const std::string& inPath)
 {
-	const auto contentPath = std::string(inContentPath);
-	const auto testLayoutPath = contentPath + "TestLayout/" + inTestLayoutName + FILE_EXTENSION;
+	files.emplace_back(inPath, FileStamp::read(inPath));
+}
+
+bool DataManager::Sources::haveChanged() const
+{
+	return std::ranges::any_of(files, [](const auto& inFile)
+	{
+		return FileStamp::read(inFile.first) != inFile.second;
+	});
+}
+
+void DataManager::Sources::loadFromBundle(BundleReader& ioReader)
+{
+	//The bundle was only opened if its sources didn't change, their current stamps are the ones they had when they were read
+	for(auto fileCount = ioReader.readCount(sizeof(uint32_t)); fileCount > 0; --fileCount)
+	{
+		add(std::string(ioReader.readString()));
+	}
+}
+
+void DataManager::Sources::saveToBundle(BundleWriter& ioWriter) const
+{
+	ioWriter.write(static_cast<uint32_t>(files.size()));
+	for(const auto& [path, stamp] : files)
+	{
+		ioWriter.writeString(path);
+	}
+}
+
+bool DataManager::loadSources()
+{
+	const auto testLayoutPath = contentPath + "TestLayout/" + testLayoutName + FILE_EXTENSION;
+	testLayoutSources.add(testLayoutPath);
 	assert(std::filesystem::exists(testLayoutPath) && std::filesystem::is_regular_file(testLayoutPath));
 	pugi::xml_document testLayoutDocument;
 	testLayoutDocument.load_file(testLayoutPath.c_str());
 	const auto testLayoutNode = testLayoutDocument.document_element();
 	testLayout.numStoryToGenerate = testLayoutNode.child("numstoriestogenerate").text().as_int();
 	testLayout.maxNumberOfRewrites = testLayoutNode.child("maxnumberofrewrites").text().as_int();
+	if(const auto seedNode = testLayoutNode.child("seed"))
+	{
+		layoutSeed = seedNode.text().as_ullong();
+	}
+	if(const auto weightRulesByMetricsNode = testLayoutNode.child("weightrulesbymetrics"))
+	{
+		testLayout.bWeightRulesByMetrics = weightRulesByMetricsNode.text().as_bool();
+	}
+	if(const auto renderImagesNode = testLayoutNode.child("renderimages"))
+	{
+		testLayout.bRenderImages = renderImagesNode.text().as_bool();
+	}
+	if(const auto watchSourcesNode = testLayoutNode.child("watchsources"))
+	{
+		testLayout.bWatchSources = watchSourcesNode.text().as_bool();
+	}
+	if(const auto threadCountNode = testLayoutNode.child("threadcount"))
+	{
+		testLayout.threadCount = threadCountNode.text().as_uint();
+	}
 
 	for(const auto& metricToOptimize : testLayoutNode.child("metricstooptimize").children("metric"))
 	{
@@ -37,13 +205,89 @@ void DataManager::init(const char* inTestLayoutName, const char* inContentPath)
 		testLayout.metricsToAnalyze.emplace_back(metricToAnalyze.attribute("name").as_string());
 	}
 	
-	const auto worldGraphPath = contentPath + "SocialGraphs/" + testLayoutNode.child("socialgraph").text().as_string() + FILE_EXTENSION;
-	assert(std::filesystem::exists(worldGraphPath) && std::filesystem::is_regular_file(worldGraphPath));
-	worldGraph.loadFromXml(worldGraphPath);
+	const auto bHasLoadedWorldGraph = loadWorldGraph(contentPath + "SocialGraphs/" + testLayoutNode.child("socialgraph").text().as_string() + FILE_EXTENSION);
+	loadRules(contentPath + INITIALIZATION_RULES_FOLDER, testLayoutNode.child("initializationrules"), initializationRules);
+	loadRules(contentPath + REWRITE_RULES_FOLDER, testLayoutNode.child("rewriterules"), rewriteRules);	
+	return bHasLoadedWorldGraph;
+}
+
+bool DataManager::loadWorldGraph(const std::string& inPath)
+{
+	worldGraphSources.add(inPath);
+	Graph loadedWorldGraph;
+	if(!loadedWorldGraph.loadFromXml(inPath))
+	{
+		return false;
+	}
+	worldGraph = std::move(loadedWorldGraph);
+	return true;
+}
+
+void DataManager::chooseSeed()
+{
+	if(layoutSeed)
+	{
+		testLayout.seed = *layoutSeed;
+	}
+	else
+	{
+		std::random_device randomDevice;
+		testLayout.seed = static_cast<uint64_t>(randomDevice()) << 32 | randomDevice();
+	}
+}
+
+void DataManager::compileMatchPlans(const std::vector<Rule*>& inRules)
+{
+	//Conditions are planned once here for all the searches they will be part of
+	auto* threadPool = ThreadPool::getInstance();
+	const auto matchPlansCompilation = threadPool->createTaskGroup();
+	std::vector<std::future<void> > matchPlans;
+	matchPlans.reserve(inRules.size());
+	for(auto* rule : inRules)
+	{
+		matchPlans.emplace_back(threadPool->submit(matchPlansCompilation, [this, rule]()
+		{
+			rule->socialConditions.compileMatchPlan(&worldGraph);
+			rule->storyConditions.compileMatchPlan();
+		}));
+	}
+	for(auto& matchPlan : matchPlans)
+	{
+		threadPool->wait(matchPlansCompilation, matchPlan);
+	}
+}
 
-	const auto rulesPath = contentPath + "Rules/";
-	loadRules(rulesPath + "InitializationRules/", testLayoutNode.child("initializationrules"), initializationRules);
-	loadRules(rulesPath + "RewriteRules/", testLayoutNode.child("rewriterules"), rewriteRules);	
+std::vector<Rule*> DataManager::getRules()
+{
+	std::vector<Rule*> result;
+	result.reserve(initializationRules.size() + rewriteRules.size());
+	for(auto* rules : {&initializationRules, &rewriteRules})
+	{
+		for(auto& rule : *rules)
+		{
+			result.emplace_back(&rule);
+		}
+	}
+	return result;
+}
+
+void DataManager::loadMatchCache() const
+{
+	std::list<const Graph*> socialConditions;
+	for(const auto& rule : initializationRules)
+	{
+		socialConditions.emplace_back(&rule.socialConditions);
+	}
+	for(const auto& rule : rewriteRules)
+	{
+		socialConditions.emplace_back(&rule.socialConditions);
+	}
+	MatchCache::getInstance()->load(matchCachePath, worldGraph, socialConditions);
+}
+
+void DataManager::saveMatchCache() const
+{
+	MatchCache::getInstance()->save(matchCachePath);
 }
 
 #ifndef NDEBUG
@@ -51,6 +295,7 @@ void DataManager::printTestLayout() const
 {
 	PRINTLN("NUM STORY TO GENERATE : " + std::to_string(testLayout.numStoryToGenerate));
 	PRINTLN("MAX NUMBER OF REWRITE :" + std::to_string(testLayout.maxNumberOfRewrites));
+	PRINTLN("SEED : " + std::to_string(testLayout.seed));
 	PRINTLN("");
 	
 	PRINT_SEPARATOR();
@@ -82,14 +327,18 @@ void DataManager::printStoryModifications()
 		PRINT_SEPARATOR();
 		PRINT_SEPARATOR();
 		PRINTLN("");
-		for(const auto& [modificationName, commandsData] : rule.nodeModificationArguments)
+		for(int storyNodeIndex = 0; storyNodeIndex < static_cast<int>(rule.nodesModifications.size()); ++storyNodeIndex)
 		{
+			if(rule.nodesModifications[storyNodeIndex]->empty())
+			{
+				continue;
+			}
 			PRINT_SEPARATOR();
-			PRINTLN("MODIFICATION NAME :" + modificationName);
+			PRINTLN("MODIFICATION NAME :" + rule.storyGraph.getNodeByIndex(storyNodeIndex)->getName());
 			PRINT_SEPARATOR();
-			for(const auto& commandData : commandsData)
+			for(const auto& command : *rule.nodesModifications[storyNodeIndex])
 			{
-				CommandRegistry::getInstance()->executeCommand({}, commandData);
+				CommandRegistry::executeCommand({}, command);
 				PRINT_SEPARATOR();
 			}
 			PRINTLN("");
@@ -104,10 +353,11 @@ void DataManager::saveDataAsDotFormat(const bool inPrintWorldGraph, const bool i
 	std::string color = "lightblue4";
 	std::string fontColor = "lightblue4";
 	std::string baseOutputPath = "./Output/SocialGraph";
+	auto* outputPipeline = OutputPipeline::getInstance();
 
 	if(inPrintWorldGraph)
 	{
-		worldGraph.saveAsDotFile(color, fontColor, baseOutputPath);
+		outputPipeline->render(worldGraph.saveAsDotFile(color, fontColor, baseOutputPath));
 	}
 
 	if(inPrintRules)
@@ -117,25 +367,25 @@ void DataManager::saveDataAsDotFormat(const bool inPrintWorldGraph, const bool i
 		
 		char i = '0';
 		baseOutputPath = "./Output/InitRules/";
-		for(const auto& [name, socialConditions, storyConditions, storyGraph, nodeModificationArguments, appliesOnce] : initializationRules)
+		for(const auto& [name, socialConditions, storyConditions, storyGraph, nodesModifications, socialNodesRolesSlots, storyNodesTargetsSlots, appliesOnce] : initializationRules)
 		{
 			auto outputPath(baseOutputPath);
 			outputPath.push_back(i);
-			storyGraph.saveAsDotFile(color, fontColor, outputPath);
-			socialConditions.saveAsDotFile(color, fontColor, outputPath);
-			storyConditions.saveAsDotFile(color, fontColor, outputPath);
+			outputPipeline->render(storyGraph.saveAsDotFile(color, fontColor, outputPath));
+			outputPipeline->render(socialConditions.saveAsDotFile(color, fontColor, outputPath));
+			outputPipeline->render(storyConditions.saveAsDotFile(color, fontColor, outputPath));
 			++i;
 		}
 
 		i = '0';
 		baseOutputPath = "./Output/RewriteRules/";
-		for(const auto& [name, socialConditions, storyConditions, storyGraph, nodeModificationArguments, appliesOnce] : rewriteRules)
+		for(const auto& [name, socialConditions, storyConditions, storyGraph, nodesModifications, socialNodesRolesSlots, storyNodesTargetsSlots, appliesOnce] : rewriteRules)
 		{
 			auto outputPath(baseOutputPath);
 			outputPath.push_back(i);
-			storyGraph.saveAsDotFile(color, fontColor, outputPath);
-			socialConditions.saveAsDotFile(color, fontColor, outputPath);
-			storyConditions.saveAsDotFile(color, fontColor, outputPath);
+			outputPipeline->render(storyGraph.saveAsDotFile(color, fontColor, outputPath));
+			outputPipeline->render(socialConditions.saveAsDotFile(color, fontColor, outputPath));
+			outputPipeline->render(storyConditions.saveAsDotFile(color, fontColor, outputPath));
 			++i;
 		}
 	}
@@ -152,6 +402,12 @@ const Graph& DataManager::getWorldGraph() const
 	return worldGraph;
 }
 
+const GraphSnapshot& DataManager::getWorldSnapshot() const
+{
+	assert(worldGraph.getSnapshot());
+	return *worldGraph.getSnapshot();
+}
+
 const std::list<Rule>& DataManager::getInitializationRules() const
 {
 	return initializationRules;
@@ -185,90 +441,424 @@ void DataManager::readArguments(const pugi::xml_node inParsedArguments, std::vec
 	}
 }
 
-void DataManager::loadRules(const std::string& inRulesPath, const pugi::xml_node& inRulesListingNode, std::list<Rule>& outRulesList) const
+std::unique_ptr<DataManager::ParsedRuleFiles> DataManager::parseRuleFiles(const std::string& inRuleFolderPath, const std::string& inRuleName)
 {
-	for(const auto& ruleName : inRulesListingNode.children())
+	auto result = std::make_unique<ParsedRuleFiles>();
+	const auto rulePathExtensionless = inRuleFolderPath + inRuleName;
+
+	auto filePath = rulePathExtensionless + FILE_EXTENSION;
+	result->sources.add(filePath);
+	assert(std::filesystem::exists(filePath) && std::filesystem::is_regular_file(filePath));
+	result->attributes.load_file(filePath.c_str());
+
+	filePath = rulePathExtensionless + "_Social_Condition" + FILE_EXTENSION; 
+	result->sources.add(filePath);
+	assert(std::filesystem::exists(filePath) && std::filesystem::is_regular_file(filePath));
+	result->socialConditions.load_file(filePath.c_str());
+
+	filePath = rulePathExtensionless + "_Story_Graph_Condition" + FILE_EXTENSION; 
+	result->sources.add(filePath);
+	if(std::filesystem::exists(filePath) && std::filesystem::is_regular_file(filePath))
 	{
-		Rule rule;
+		result->storyConditions.load_file(filePath.c_str());
+	}
 
-		rule.name = ruleName.text().as_string();
+	filePath = rulePathExtensionless + "_Story_Graph" + FILE_EXTENSION; 
+	result->sources.add(filePath);
+	assert(std::filesystem::exists(filePath) && std::filesystem::is_regular_file(filePath));
+	result->storyGraph.load_file(filePath.c_str());
 
-		const auto ruleFolderPath = inRulesPath + rule.name + "/";
-		const auto rulePathExtensionless = ruleFolderPath + ruleName.text().as_string();
+	//Modifications are only read here, they are parsed once per distinct content when the rule is built
+	for(const auto& storyNode : result->storyGraph.document_element().child("nodes").children("node"))
+	{
+		if(const auto modificationName = std::string(storyNode.attribute("modification").as_string()); modificationName != "None" && !result->modificationsContents.contains(modificationName))
+		{
+			filePath = inRuleFolderPath + "Modifications/" + modificationName;
+			result->sources.add(filePath);
+			assert(std::filesystem::exists(filePath) && std::filesystem::is_regular_file(filePath));
+			std::ifstream file(filePath, std::ios::binary);
+			result->modificationsContents.emplace(modificationName, std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()));
+		}
+	}
+	return result;
+}
 
-		auto filePath = rulePathExtensionless + FILE_EXTENSION;
-		assert(std::filesystem::exists(filePath) && std::filesystem::is_regular_file(filePath));
-		pugi::xml_document ruleAttributes;
-		ruleAttributes.load_file(filePath.c_str());
-		rule.appliesOnce = ruleAttributes.document_element().attribute("applyonce").as_bool();
+std::shared_ptr<const std::vector<CompiledCommand> > DataManager::loadModification(const std::string& inContent)
+{
+	auto& commands = modificationsByContent[inContent];
+	if(commands)
+	{
+		return commands;
+	}
+
+	pugi::xml_document modificationDocument;
+	modificationDocument.load_buffer(inContent.data(), inContent.size());
+	const auto modificationNode = modificationDocument.document_element();
+
+	//Commands are compiled once here, so that generating conditions from them neither looks them up by name nor decodes their arguments
+	std::vector<CompiledCommand> compiledCommands;
+	for(const auto& command : modificationNode.children("Method"))
+	{
+		CommandData commandData;
+		commandData.name = command.attribute("name").as_string();
+
+		commandData.caller = command.attribute("self").as_string();
+		
+		const auto parsedArguments = command.child("args");
+		readArguments(parsedArguments, commandData.arguments);
+
+		compiledCommands.emplace_back(CommandRegistry::getInstance()->compileCommand(commandData));
+	}
 
-		filePath = rulePathExtensionless + "_Social_Condition" + FILE_EXTENSION; 
-		assert(std::filesystem::exists(filePath) && std::filesystem::is_regular_file(filePath));
-		rule.socialConditions.loadFromXml(filePath);
+	for(const auto& command : modificationNode.children("Attribute"))
+	{
+		std::vector<std::any> arguments;
+		arguments.reserve(2);
+		arguments.emplace_back(std::string(command.attribute("key").as_string()));
+		arguments.emplace_back(NodeAttribute(command.attribute("type").as_string("str"), command.attribute("value").as_string()));
+		
+		compiledCommands.emplace_back
+		(
+			CommandRegistry::getInstance()->compileCommand
+			(
+				CommandData
+				{
+					"modify_attribute",
+					command.attribute("name").as_string(),
+					arguments
+				}
+			)
+		);
+	}
+
+	commands = std::make_shared<const std::vector<CompiledCommand> >(std::move(compiledCommands));
+	return commands;
+}
+
+void DataManager::loadRules(const std::string& inRulesPath, const pugi::xml_node& inRulesListingNode, std::list<Rule>& outRulesList)
+{
+	//Files are read and parsed concurrently. Rules are then built from them in listing order, so that symbols and roles are numbered the same way on every run
+	auto* threadPool = ThreadPool::getInstance();
+	const auto rulesParsing = threadPool->createTaskGroup();
+	std::vector<std::pair<std::string, std::future<std::unique_ptr<ParsedRuleFiles> > > > rulesFiles;
+	for(const auto& ruleNameNode : inRulesListingNode.children())
+	{
+		std::string ruleName = ruleNameNode.text().as_string();
+		auto ruleFiles = threadPool->submit(rulesParsing, [ruleFolderPath = inRulesPath + ruleName + "/", ruleName]()
+		{
+			return parseRuleFiles(ruleFolderPath, ruleName);
+		});
+		rulesFiles.emplace_back(std::move(ruleName), std::move(ruleFiles));
+	}
+
+	const auto noModification = std::make_shared<const std::vector<CompiledCommand> >();
+	for(auto& [ruleName, ruleFiles] : rulesFiles)
+	{
+		const auto files = threadPool->wait(rulesParsing, ruleFiles);
+		buildRule(std::move(ruleName), *files, noModification, outRulesList.emplace_back());
+	}
+}
+
+void DataManager::buildRule(std::string inRuleName, ParsedRuleFiles& ioFiles, const std::shared_ptr<const std::vector<CompiledCommand> >& inNoModification, Rule& outRule)
+{
+	outRule.name = std::move(inRuleName);
+	outRule.appliesOnce = ioFiles.attributes.document_element().attribute("applyonce").as_bool();
+	outRule.socialConditions.loadFromXml(ioFiles.socialConditions.document_element());
+	if(const auto storyConditions = ioFiles.storyConditions.document_element())
+	{
+		outRule.storyConditions.loadFromXml(storyConditions);
+	}
+	const auto storyGraph = ioFiles.storyGraph.document_element();
+	outRule.storyGraph.loadFromXml(storyGraph);
+	assignRolesSlots(outRule);
 
-		filePath = rulePathExtensionless + "_Story_Graph_Condition" + FILE_EXTENSION; 
-		if(std::filesystem::exists(filePath) && std::filesystem::is_regular_file(filePath))
+	//Rules sharing a modification file, or holding copies of the same one, share its commands
+	outRule.nodesModifications.resize(outRule.storyGraph.getNodeCount(), inNoModification);
+	for(const auto& storyNode : storyGraph.child("nodes").children("node"))
+	{
+		if(const auto modificationName = std::string(storyNode.attribute("modification").as_string()); modificationName != "None")
 		{
-			rule.storyConditions.loadFromXml(filePath);
+			outRule.nodesModifications[outRule.storyGraph.getNodeByName(storyNode.attribute("name").as_string())->getIndex()] = loadModification(ioFiles.modificationsContents.at(modificationName));
 		}
+	}
+	rulesSources[&outRule] = std::move(ioFiles.sources);
+}
 
-		filePath = rulePathExtensionless + "_Story_Graph" + FILE_EXTENSION; 
-		assert(std::filesystem::exists(filePath) && std::filesystem::is_regular_file(filePath));
-		pugi::xml_document document;
-		document.load_file(filePath.c_str());
-		const auto storyGraph = document.document_element();
-		rule.storyGraph.loadFromXml(storyGraph);
+void DataManager::assignRolesSlots(Rule& ioRule)
+{
+	auto* roleTable = RoleTable::getInstance();
+	ioRule.socialNodesRolesSlots.reserve(ioRule.socialConditions.getNodeCount());
+	for(int socialNodeIndex = 0; socialNodeIndex < ioRule.socialConditions.getNodeCount(); ++socialNodeIndex)
+	{
+		ioRule.socialNodesRolesSlots.emplace_back(roleTable->getSlot(ioRule.socialConditions.getNodeByIndex(socialNodeIndex)->getNameSymbol()));
+	}
+	ioRule.storyNodesTargetsSlots.reserve(ioRule.storyGraph.getNodeCount());
+	for(int storyNodeIndex = 0; storyNodeIndex < ioRule.storyGraph.getNodeCount(); ++storyNodeIndex)
+	{
+		ioRule.storyNodesTargetsSlots.emplace_back(roleTable->getSlot(ioRule.storyGraph.getNodeByIndex(storyNodeIndex)->getAttribute(Symbols::TARGET).getText()));
+	}
+}
 
-		for(auto& storyNode : storyGraph.child("nodes").children("node"))
+void DataManager::writeCommands(BundleWriter& ioWriter, const std::vector<CompiledCommand>& inCommands)
+{
+	//Arguments are written as they were before being compiled, in the order of the command signature, so that reading them numbers the roles the same way
+	const auto* roleTable = RoleTable::getInstance();
+	ioWriter.write(static_cast<uint32_t>(inCommands.size()));
+	for(const auto& command : inCommands)
+	{
+		ioWriter.writeString(command.command->name);
+		ioWriter.writeSymbol(roleTable->getRoleName(command.callerSlot));
+		const auto& signature = command.command->signature;
+		for(size_t argumentPosition = 0; argumentPosition < signature.size(); ++argumentPosition)
 		{
-			if(const auto modificationName = std::string(storyNode.attribute("modification").as_string()); modificationName != "None")
+			switch(signature[argumentPosition])
 			{
-				pugi::xml_document modificationDocument;
-				filePath = ruleFolderPath + "Modifications/";
-				filePath += modificationName;
-				assert(std::filesystem::exists(filePath) && std::filesystem::is_regular_file(filePath));
-				modificationDocument.load_file(filePath.c_str());
-				const auto modificationNode = modificationDocument.document_element();
-
-				std::list<CommandData> commandsData;
-			
-				for(const auto& command : modificationNode.children("Method"))
+				case CommandArgumentType::Role:
+					ioWriter.writeSymbol(roleTable->getRoleName(command.getArgument<RoleArgument>(argumentPosition).slot));
+					break;
+				case CommandArgumentType::Symbol:
+					ioWriter.writeSymbol(command.getArgument<Symbol>(argumentPosition));
+					break;
+				case CommandArgumentType::Symbols:
 				{
-					CommandData commandData;
-					commandData.name = command.attribute("name").as_string();
-
-					commandData.caller = command.attribute("self").as_string();
-					
-					std::vector<std::any> arguments;
-					const auto parsedArguments = command.child("args");
-					readArguments(parsedArguments, arguments);
-					commandData.arguments = arguments;
-
-					commandsData.emplace_back(commandData);
+					const auto& symbols = command.getArgument<std::vector<Symbol> >(argumentPosition);
+					ioWriter.write(static_cast<uint32_t>(symbols.size()));
+					for(const auto symbol : symbols)
+					{
+						ioWriter.writeSymbol(symbol);
+					}
+					break;
 				}
+				case CommandArgumentType::Attribute:
+				{
+					const auto& attribute = command.getArgument<NodeAttribute>(argumentPosition);
+					ioWriter.writeSymbol(attribute.getTypeName());
+					ioWriter.writeSymbol(attribute.getText());
+					break;
+				}
+			}
+		}
+	}
+}
 
-				for(const auto& command : modificationNode.children("Attribute"))
+std::vector<CompiledCommand> DataManager::readCommands(BundleReader& ioReader)
+{
+	//Roles are only numbered for symbols actually read, a failed read would otherwise number a role of its own
+	auto* roleTable = RoleTable::getInstance();
+	const auto readRoleSlot = [&ioReader, roleTable]()
+	{
+		const auto roleName = ioReader.readSymbol();
+		return ioReader.hasFailed() ? NONE : roleTable->getSlot(roleName);
+	};
+	std::vector<CompiledCommand> result(ioReader.readCount(sizeof(uint32_t) * 2));
+	for(auto& command : result)
+	{
+		command.command = CommandRegistry::getInstance()->getCommand(std::string(ioReader.readString()));
+		if(!command.command) //Only commands declared by this build can be read back
+		{
+			ioReader.fail();
+			return {};
+		}
+		command.callerSlot = readRoleSlot();
+		const auto& signature = command.command->signature;
+		command.arguments.reserve(signature.size());
+		for(const auto argumentType : signature)
+		{
+			switch(argumentType)
+			{
+				case CommandArgumentType::Role:
+					command.arguments.emplace_back(RoleArgument{readRoleSlot()});
+					break;
+				case CommandArgumentType::Symbol:
+					command.arguments.emplace_back(ioReader.readSymbol());
+					break;
+				case CommandArgumentType::Symbols:
+				{
+					std::vector<Symbol> symbols(ioReader.readCount(sizeof(uint32_t)));
+					for(auto& symbol : symbols)
+					{
+						symbol = ioReader.readSymbol();
+					}
+					command.arguments.emplace_back(std::move(symbols));
+					break;
+				}
+				case CommandArgumentType::Attribute:
 				{
-					std::vector<std::any> arguments;
-					arguments.reserve(2);
-					arguments.emplace_back(std::string(command.attribute("key").as_string()));
-					arguments.emplace_back(std::string(command.attribute("value").as_string()));
-					
-					commandsData.emplace_back
-					(
-						CommandData
-						{
-							"modify_attribute",
-							command.attribute("name").as_string(),
-							arguments
-						}
-					);
+					const auto attributeTypeName = ioReader.readSymbol();
+					command.arguments.emplace_back(NodeAttribute(attributeTypeName, ioReader.readSymbol()));
+					break;
 				}
+			}
+		}
+	}
+	return result;
+}
+
+void DataManager::forgetUnusedModifications()
+{
+	//Rules are built on this thread only, a modification held by the map alone is no longer used by any rule
+	std::erase_if(modificationsByContent, [](const auto& inModification)
+	{
+		return inModification.second.use_count() == 1;
+	});
+}
+
+void DataManager::clearData()
+{
+	testLayout = TestLayout();
+	layoutSeed.reset();
+	worldGraph = Graph();
+	initializationRules.clear();
+	rewriteRules.clear();
+	testLayoutSources = Sources();
+	worldGraphSources = Sources();
+	rulesSources.clear();
+}
+
+bool DataManager::loadBundle(const std::string& inPath)
+{
+	BundleReader reader;
+	if(!reader.open(inPath))
+	{
+		return false;
+	}
 
-				rule.nodeModificationArguments.insert({storyNode.attribute("name").as_string(), commandsData});
+	testLayout.numStoryToGenerate = reader.read<int32_t>();
+	testLayout.maxNumberOfRewrites = reader.read<int32_t>();
+	const auto bHasSeed = reader.read<bool>();
+	if(const auto seed = reader.read<uint64_t>(); bHasSeed)
+	{
+		layoutSeed = seed;
+	}
+	testLayout.bWeightRulesByMetrics = reader.read<bool>();
+	testLayout.bRenderImages = reader.read<bool>();
+	testLayout.bWatchSources = reader.read<bool>();
+	testLayout.threadCount = reader.read<uint32_t>();
+	for(auto metricCount = reader.readCount(8); metricCount > 0; --metricCount)
+	{
+		const auto metricName = reader.readString();
+		testLayout.metricsToOptimize.emplace_back(std::string(metricName), reader.read<int32_t>());
+	}
+	for(auto metricCount = reader.readCount(4); metricCount > 0; --metricCount)
+	{
+		testLayout.metricsToAnalyze.emplace_back(reader.readString());
+	}
+	testLayoutSources.loadFromBundle(reader);
+
+	worldGraph.loadFromBundle(reader);
+	worldGraphSources.loadFromBundle(reader);
+
+	//Rules are read in the order they were loaded from their sources, so that roles are numbered the same way
+	const auto noModification = std::make_shared<const std::vector<CompiledCommand> >();
+	std::vector<std::shared_ptr<const std::vector<CompiledCommand> > > modifications;
+	for(auto* rules : {&initializationRules, &rewriteRules})
+	{
+		for(auto ruleCount = reader.readCount(5); ruleCount > 0 && !reader.hasFailed(); --ruleCount)
+		{
+			auto& rule = rules->emplace_back();
+			rule.name = reader.readString();
+			rule.appliesOnce = reader.read<bool>();
+			rule.socialConditions.loadFromBundle(reader);
+			rule.storyConditions.loadFromBundle(reader);
+			rule.storyGraph.loadFromBundle(reader);
+			rulesSources[&rule].loadFromBundle(reader);
+			if(reader.hasFailed()) //Roles are only numbered for rules read whole
+			{
+				break;
+			}
+			assignRolesSlots(rule);
+
+			rule.nodesModifications.reserve(rule.storyGraph.getNodeCount());
+			for(int storyNodeIndex = 0; storyNodeIndex < rule.storyGraph.getNodeCount(); ++storyNodeIndex)
+			{
+				if(const auto modificationIndex = reader.read<int32_t>(); modificationIndex == NONE)
+				{
+					rule.nodesModifications.emplace_back(noModification);
+				}
+				else if(modificationIndex < 0 || modificationIndex > static_cast<int32_t>(modifications.size()))
+				{
+					reader.fail();
+					rule.nodesModifications.emplace_back(noModification);
+				}
+				else
+				{
+					if(modificationIndex == static_cast<int32_t>(modifications.size())) //First use, the commands follow
+					{
+						modifications.emplace_back(std::make_shared<const std::vector<CompiledCommand> >(readCommands(reader)));
+					}
+					rule.nodesModifications.emplace_back(modifications[modificationIndex]);
+				}
 			}
 		}
+	}
+	//A bundle that can't be read whole is ignored, the data is then read again from the XML sources
+	if(reader.hasFailed() || !reader.isAtEnd())
+	{
+		clearData();
+		return false;
+	}
+	return true;
+}
+
+void DataManager::saveBundle(const std::string& inPath) const
+{
+	BundleWriter writer;
+	writer.write(static_cast<int32_t>(testLayout.numStoryToGenerate));
+	writer.write(static_cast<int32_t>(testLayout.maxNumberOfRewrites));
+	writer.write(layoutSeed.has_value());
+	writer.write(layoutSeed.value_or(0));
+	writer.write(testLayout.bWeightRulesByMetrics);
+	writer.write(testLayout.bRenderImages);
+	writer.write(testLayout.bWatchSources);
+	writer.write(static_cast<uint32_t>(testLayout.threadCount));
+	writer.write(static_cast<uint32_t>(testLayout.metricsToOptimize.size()));
+	for(const auto& [name, weight] : testLayout.metricsToOptimize)
+	{
+		writer.writeString(name);
+		writer.write(static_cast<int32_t>(weight));
+	}
+	writer.write(static_cast<uint32_t>(testLayout.metricsToAnalyze.size()));
+	for(const auto& name : testLayout.metricsToAnalyze)
+	{
+		writer.writeString(name);
+	}
+	testLayoutSources.saveToBundle(writer);
+	auto sources = testLayoutSources.files;
 
-		outRulesList.emplace_back(rule);
+	worldGraph.saveToBundle(writer);
+	worldGraphSources.saveToBundle(writer);
+	sources.insert(sources.end(), worldGraphSources.files.begin(), worldGraphSources.files.end());
+
+	//Modifications are written where they are first used, later uses refer to them by their number so that they stay shared once read back
+	std::unordered_map<const std::vector<CompiledCommand>*, int32_t> modificationsIndexes;
+	for(const auto* rules : {&initializationRules, &rewriteRules})
+	{
+		writer.write(static_cast<uint32_t>(rules->size()));
+		for(const auto& rule : *rules)
+		{
+			writer.writeString(rule.name);
+			writer.write(rule.appliesOnce);
+			rule.socialConditions.saveToBundle(writer);
+			rule.storyConditions.saveToBundle(writer);
+			rule.storyGraph.saveToBundle(writer);
+			const auto& ruleSources = rulesSources.at(&rule);
+			ruleSources.saveToBundle(writer);
+			sources.insert(sources.end(), ruleSources.files.begin(), ruleSources.files.end());
+			for(const auto& modification : rule.nodesModifications)
+			{
+				if(modification->empty())
+				{
+					writer.write<int32_t>(NONE);
+					continue;
+				}
+				const auto [modificationIndex, bIsFirstUse] = modificationsIndexes.try_emplace(modification.get(), static_cast<int32_t>(modificationsIndexes.size()));
+				writer.write(modificationIndex->second);
+				if(bIsFirstUse)
+				{
+					writeCommands(writer, *modification);
+				}
+			}
+		}
 	}
+	writer.save(inPath, sources);
 }
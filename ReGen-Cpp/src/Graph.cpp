@@ -1,44 +1,178 @@
 #include "Graph.h"
 
+#include <charconv>
 #include <filesystem>
 #include <fstream>
+#include <iostream>
+#include <tuple>
 #include <pugixml.hpp>
 
+#include "Bundle.h"
 #include "Conditions.h"
-#include "Utils.h"
+#include "GraphSnapshot.h"
+#include "SubGraphMatcher.h"
+#include "XmlStreamReader.h"
+
+NodeAttribute::NodeAttribute() : type(Type::String), intValue(0)
+{
+}
+
+NodeAttribute::NodeAttribute(const Symbol inTypeName, const Symbol inText) : text(inText), type(Type::String), intValue(0)
+{
+	const auto& typeName = inTypeName.getString();
+	const auto& textString = inText.getString();
+	const auto* textEnd = textString.data() + textString.size();
+	if(typeName == "bool")
+	{
+		if(textString == "True" || textString == "true" || textString == "1")
+		{
+			type = Type::Bool;
+			boolValue = true;
+		}
+		else if(textString == "False" || textString == "false" || textString == "0")
+		{
+			type = Type::Bool;
+			boolValue = false;
+		}
+	}
+	else if(typeName == "int")
+	{
+		int64_t parsedValue;
+		if(const auto [parseEnd, error] = std::from_chars(textString.data(), textEnd, parsedValue); error == std::errc() && parseEnd == textEnd)
+		{
+			type = Type::Int;
+			intValue = parsedValue;
+		}
+	}
+	else if(typeName == "float")
+	{
+		double parsedValue;
+		if(const auto [parseEnd, error] = std::from_chars(textString.data(), textEnd, parsedValue); error == std::errc() && parseEnd == textEnd)
+		{
+			type = Type::Float;
+			floatValue = parsedValue;
+		}
+	}
+}
+
+NodeAttribute::Type NodeAttribute::getType() const
+{
+	return type;
+}
+
+Symbol NodeAttribute::getTypeName() const
+{
+	static const std::array<Symbol, 4> typesNames{"str", "bool", "int", "float"};
+	return typesNames[static_cast<size_t>(type)];
+}
+
+Symbol NodeAttribute::getText() const
+{
+	return text;
+}
+
+bool NodeAttribute::getBool() const
+{
+	assert(type == Type::Bool);
+	return boolValue;
+}
+
+int64_t NodeAttribute::getInt() const
+{
+	assert(type == Type::Int);
+	return intValue;
+}
+
+double NodeAttribute::getFloat() const
+{
+	assert(type == Type::Float);
+	return floatValue;
+}
+
+bool NodeAttribute::operator==(const NodeAttribute& inNodeAttribute) const
+{
+	if(type == inNodeAttribute.type)
+	{
+		switch(type)
+		{
+			case Type::String:
+				return text == inNodeAttribute.text;
+			case Type::Bool:
+				return boolValue == inNodeAttribute.boolValue;
+			case Type::Int:
+				return intValue == inNodeAttribute.intValue;
+			case Type::Float:
+				return floatValue == inNodeAttribute.floatValue;
+		}
+	}
+	return isNumber() && inNodeAttribute.isNumber() && toFloat() == inNodeAttribute.toFloat();
+}
+
+std::partial_ordering NodeAttribute::operator<=>(const NodeAttribute& inNodeAttribute) const
+{
+	if(type == Type::Int && inNodeAttribute.type == Type::Int)
+	{
+		return intValue <=> inNodeAttribute.intValue;
+	}
+	if(type == Type::Bool && inNodeAttribute.type == Type::Bool)
+	{
+		return boolValue <=> inNodeAttribute.boolValue;
+	}
+	if(isNumber() && inNodeAttribute.isNumber())
+	{
+		return toFloat() <=> inNodeAttribute.toFloat();
+	}
+	return std::partial_ordering::unordered;
+}
+
+bool NodeAttribute::isNumber() const
+{
+	return type == Type::Int || type == Type::Float;
+}
+
+double NodeAttribute::toFloat() const
+{
+	return type == Type::Int ? static_cast<double>(intValue) : floatValue;
+}
 
 Node::Node() : bIsValid(true), index(NONE)
 {
 }
 
-Node::Node(std::string inName, std::unordered_map<std::string, NodeAttribute> inAttributes) : name(std::move(inName)), attributes(std::move(inAttributes)), bIsValid(true), index(NONE)
+Node::Node(const Symbol inName, NodeAttributes inAttributes) : name(inName), attributes(std::move(inAttributes)), bIsValid(true), index(NONE)
 {
 }
 
 const std::string& Node::getName() const
+{
+	return name.getString();
+}
+
+Symbol Node::getNameSymbol() const
 {
 	return name;
 }
 
-void Node::setName(const std::string& inName)
+void Node::setName(const Symbol inName)
 {
 	name = inName;
 	//TODO change key in nodesByName map and in edgesByNodeNames, not already done because it is atm only used on not yet added nodes
 }
 
-const std::unordered_map<std::string, NodeAttribute>& Node::getAttributes() const
+const NodeAttributes& Node::getAttributes() const
 {
 	return attributes;
 }
 
-const NodeAttribute& Node::getAttribute(const std::string& inAttributeName) const
+const NodeAttribute& Node::getAttribute(const Symbol inAttributeName) const
 {
 	return attributes.at(inAttributeName);
 }
 
-void Node::setAttribute(const std::string& inAttributeName, const NodeAttribute& inAttributeValue)
+void Node::setAttribute(const Symbol inAttributeName, const NodeAttribute& inAttributeValue)
 {
 	attributes[inAttributeName] = inAttributeValue;
+	//Doesn't update the attribute index of the graph, use Graph::setNodeAttribute on already added nodes
 }
 
 std::shared_ptr<ConditionsBlock> Node::getConditionsBlock() const
@@ -55,12 +189,12 @@ void Node::setConditionsBlock(ConditionsBlock& inConditionsBlock) const
 	conditionsBlock = std::make_shared<ConditionsBlock>(inConditionsBlock);
 }
 
-const std::list<std::shared_ptr<Edge>>& Node::getIncomingEdges() const
+const std::vector<int>& Node::getIncomingEdges() const
 {
 	return incomingEdges;
 }
 
-const std::list<std::shared_ptr<Edge>>& Node::getOutgoingEdges() const
+const std::vector<int>& Node::getOutgoingEdges() const
 {
 	return outgoingEdges;
 }
@@ -75,53 +209,14 @@ bool Node::isValid() const
 	return bIsValid;
 }
 
-void Node::clearEdges()
-{
-	incomingEdges.clear();
-	outgoingEdges.clear();
-}
-
-std::shared_ptr<Node> Node::getSourceNodeFromIncomingEdgeWithAttribute(const std::pair<std::string, std::string>& inAttribute)
-{
-	std::shared_ptr<Node> sourceNode;
-	for(const auto& incomingEdge : incomingEdges)
-	{
-		if(auto locationAttribute = incomingEdge->getAttributes().find<std::string>(inAttribute.first); locationAttribute != incomingEdge->getAttributes().end() && (inAttribute.second == "N/A" || locationAttribute->second == inAttribute.second))
-		{
-			sourceNode = incomingEdge->getSourceNode();
-			break;
-		}
-	}
-	return sourceNode;
-}
-
-std::shared_ptr<Node> Node::getTargetNodeFromOutgoingEdgeWithAttribute(const std::pair<std::string, std::string>& inAttribute)
-{
-	std::shared_ptr<Node> targetNode;
-	for(const auto& outGoingEdge : outgoingEdges)
-	{
-		if(auto locationAttribute = outGoingEdge->getAttributes().find<std::string>(inAttribute.first); locationAttribute != outGoingEdge->getAttributes().end() && (inAttribute.second == "N/A" || locationAttribute->second == inAttribute.second))
-		{
-			targetNode = outGoingEdge->getTargetNode();
-			break;
-		}
-	}
-	return targetNode;
-}
-
-bool Node::isSubNode(const Node& inParentNode)
-{
-	return containsAttributes(inParentNode) && containsEdges(incomingEdges, inParentNode.incomingEdges) && containsEdges(outgoingEdges, inParentNode.outgoingEdges);
-}
-
-bool Node::containsAttributes(const Node& inParentNode)
+bool Node::containsAttributes(const Node& inParentNode) const
 {
 	for(const auto& [parentAttributeName, parentAttributeData] : inParentNode.attributes)
 	{
 		bool containsAttribute = false;
 		for(const auto& [attributeName, attributeData] : attributes)
 		{
-			if(parentAttributeName == attributeName && (parentAttributeName == "target" || parentAttributeData.value == "N/A" || parentAttributeData.value == attributeData.value)) //TODO make virtual method for story nodes after template hell is done
+			if(parentAttributeName == attributeName && (parentAttributeName == Symbols::TARGET || parentAttributeData.getText() == Symbols::NOT_AVAILABLE || parentAttributeData.getText() == attributeData.getText())) //TODO make virtual method for story nodes after template hell is done
 			{
 				containsAttribute = true;
 				break;
@@ -135,114 +230,52 @@ bool Node::containsAttributes(const Node& inParentNode)
 	return true;
 }
 
-bool Node::containsEdges(const std::list<std::shared_ptr<Edge>>& inNodeEdges, const std::list<std::shared_ptr<Edge>>& inParentNodeEdges)
-{
-	std::list<std::shared_ptr<Edge> > foundEdges;
-	for(const auto& parentNodeEdge : inParentNodeEdges) //For each edges from parent node
-	{
-		bool containsEdges = false;
-		for(const auto& edge : inNodeEdges) //We compare it to all edges from main node
-		{
-			if //If the edge we are looking at hasn't yet been set as a sub-edge in previous iteration
-			(
-				std::ranges::none_of(foundEdges, [edge](const std::shared_ptr<Edge>& e)
-				{
-					return e.get() == edge.get();
-				})
-			)
-			{
-				for(const auto& [parentNodeEdgeAttributeName, parentNodeEdgeAttributeValue] : parentNodeEdge->getAttributes()) //Then we iterate through each attributes of the parentEdge
-				{
-					bool containsEdgeAttribute = false;
-					for(const auto& [edgeAttributeName, edgeAttributeValue] : edge->getAttributes()) //And compare it to all attributes of the currently processed main edge
-					{
-						if(parentNodeEdgeAttributeName == edgeAttributeName && (parentNodeEdgeAttributeValue == "N/A" || parentNodeEdgeAttributeValue == edgeAttributeValue)) //If it matches, we add it to our foundSubEdges list and stop checking the attributes of this edge
-						{
-							containsEdgeAttribute = true;
-							foundEdges.emplace_back(edge);
-							break;
-						}
-					}
-					if(containsEdgeAttribute) //If we found an edge with the required attributes then we stop searching for sub-edges of the currently checked parentEdge
-					{
-						containsEdges = true;
-						break;
-					}
-				}
-				if(containsEdges) //Forwarding previous statement
-				{
-					break;
-				}
-			}
-		}
-		if(!containsEdges) //If our comparison ended without entering all conditions each time, then the edges of the main node are not sub-edges of the parentNode
-		{
-			return false;
-		}
-	}
-	return true; //Else they are
-}
-
-void Node::validateNode(Conditions preConditions, bool inValid)
+Edge::Edge() : sourceIndex(NONE), targetIndex(NONE)
 {
-	PRINTLN("Validating conditions for: " + name);
-	bIsValid = inValid && bIsValid;
-
-	if(conditionsBlock)
-	{
-		if(preConditions.conflicts(conditionsBlock->postConditions))
-		{
-			PRINTLN("Invalid");
-#ifndef NDEBUG
-			preConditions.print();
-			conditionsBlock->postConditions.print();
-#endif
-			bIsValid = false;
-		}
-
-		preConditions.append(conditionsBlock->preConditions);
-	}
-
-	for(const auto& incomingEdge : incomingEdges)
-	{
-		incomingEdge->getSourceNode()->validateNode(preConditions, bIsValid);
-	}
 }
 
-Edge::Edge(std::shared_ptr<Node> inSourceNode, std::shared_ptr<Node> inTargetNode, std::unordered_map<std::string, std::string> inAttributes) : sourceNode(std::move(inSourceNode)), targetNode(std::move(inTargetNode)), attributes(std::move(inAttributes))
+Edge::Edge(const int inSourceIndex, const int inTargetIndex, EdgeAttributes inAttributes) : sourceIndex(inSourceIndex), targetIndex(inTargetIndex), attributes(std::move(inAttributes))
 {
 }
 
-std::shared_ptr<Node> Edge::getSourceNode() const
+int Edge::getSourceIndex() const
 {
-	return sourceNode;
+	return sourceIndex;
 }
 
-std::shared_ptr<Node> Edge::getTargetNode() const
+int Edge::getTargetIndex() const
 {
-	return targetNode;
+	return targetIndex;
 }
 
-const std::unordered_map<std::string, std::string>& Edge::getAttributes() const
+const EdgeAttributes& Edge::getAttributes() const
 {
 	return attributes;
 }
 
-#ifndef NDEBUG
-void Edge::print() const
+bool Edge::containsAttribute(const Edge& inParentEdge) const
 {
-	for(const auto& [attributeName, attributeValue] : attributes)
+	const auto containsParentAttribute = [this](const std::pair<Symbol, Symbol>& inParentAttribute)
 	{
-		PRINTLN(sourceNode->getName() + "_" + attributeName + "_" + attributeValue + "_" + targetNode->getName());
+		const auto attribute = attributes.find(inParentAttribute.first);
+		return attribute != attributes.end() && (inParentAttribute.second == Symbols::NOT_AVAILABLE || inParentAttribute.second == attribute->second);
+	};
+	if(inParentEdge.attributes.size() == 1) //Single relation edges, by far the most common
+	{
+		return containsParentAttribute(*inParentEdge.attributes.begin());
 	}
+	return std::ranges::any_of(inParentEdge.attributes, containsParentAttribute);
 }
-#endif
 
-Graph::Graph() : name("none"), type("default"), nodeCount(0), edgeCount(0)
+GraphUndoRecord::GraphUndoRecord(const Type inType, const int inSourceIndex, const int inTargetIndex, const int inEdgeHandle) : type(inType), sourceIndex(inSourceIndex), targetIndex(inTargetIndex), edgeHandle(inEdgeHandle)
 {
 }
 
-Graph::Graph(std::string inName, std::string inType) : name(std::move(inName)), type(std::move(inType)), nodeCount(0), edgeCount(0)
+Graph::Graph() : name("none"), type("default"), nodeCount(0), version(0), bIsInTransaction(false), transactionOperationCount(0), transactionNodeCount(0), transactionEdgeHandleCount(0)
+{
+}
+
+Graph::Graph(std::string inName, std::string inType) : name(std::move(inName)), type(std::move(inType)), nodeCount(0), version(0), bIsInTransaction(false), transactionOperationCount(0), transactionNodeCount(0), transactionEdgeHandleCount(0)
 {
 }
 
@@ -256,32 +289,42 @@ const std::string& Graph::getType() const
 	return type;
 }
 
-std::shared_ptr<Node> Graph::getNodeByName(const std::string& inName) const
+Node* Graph::getNodeByName(const Symbol inName)
 {
-	return nodesByName.at(inName);
+	return &nodes[nodesByName.at(inName)];
 }
 
-std::shared_ptr<Node> Graph::getNodeByIndex(int inIndex) const
+const Node* Graph::getNodeByName(const Symbol inName) const
 {
-	return nodesByIndex.at(inIndex);
+	return &nodes[nodesByName.at(inName)];
 }
 
-const std::unordered_map<std::string, std::shared_ptr<Node>>& Graph::getNodesByName() const
+Node* Graph::getNodeByIndex(const int inIndex)
 {
-	return nodesByName;
+	return nodes.contains(inIndex) ? &nodes[inIndex] : nullptr;
 }
 
-const std::map<int, std::shared_ptr<Node>>& Graph::getNodesByIndex() const
+const Node* Graph::getNodeByIndex(const int inIndex) const
 {
-	return nodesByIndex;
+	return nodes.contains(inIndex) ? &nodes[inIndex] : nullptr;
 }
 
-const std::map<std::pair<std::string, std::string>, std::shared_ptr<Edge>>& Graph::getEdgesByNodesNames() const
+const Edge& Graph::getEdge(const int inEdgeHandle) const
+{
+	return edges[inEdgeHandle];
+}
+
+const std::unordered_map<Symbol, int>& Graph::getNodesByName() const
+{
+	return nodesByName;
+}
+
+const std::map<std::pair<Symbol, Symbol>, int>& Graph::getEdgesByNodesNames() const
 {
 	return edgesByNodesNames;
 }
 
-const std::map<std::pair<int, int>, std::shared_ptr<Edge>>& Graph::getEdgesByNodesIndex() const
+const std::map<std::pair<int, int>, int>& Graph::getEdgesByNodesIndex() const
 {
 	return edgesByNodesIndex;
 }
@@ -293,16 +336,314 @@ int Graph::getNodeCount() const
 
 int Graph::getEdgeCount() const
 {
-	return edgeCount;
+	return edges.getSize();
+}
+
+int Graph::getVersion() const
+{
+	return version;
+}
+
+uint64_t Graph::computeContentHash() const
+{
+	//FNV-1a, std::hash isn't guaranteed to be the same from one run to another
+	uint64_t hash = 14695981039346656037ull;
+	const auto hashString = [&hash](const std::string& inString)
+	{
+		for(const auto character : inString)
+		{
+			hash = (hash ^ static_cast<unsigned char>(character)) * 1099511628211ull;
+		}
+		hash = (hash ^ 0xFF) * 1099511628211ull; //Separator, so that ("ab", "c") and ("a", "bc") differ
+	};
+
+	for(int nodeIndex = 0; nodeIndex < nodeCount; ++nodeIndex)
+	{
+		const auto* node = getNodeByIndex(nodeIndex);
+		hashString(node ? node->getName() : std::string());
+		if(node)
+		{
+			//Symbols ids depend on the interning order, the strings are hashed in alphabetical order instead
+			std::map<std::string, NodeAttribute> sortedAttributes;
+			for(const auto& [attributeName, attributeData] : node->attributes)
+			{
+				sortedAttributes.emplace(attributeName.getString(), attributeData);
+			}
+			for(const auto& [attributeName, attributeData] : sortedAttributes)
+			{
+				hashString(attributeName);
+				hashString(attributeData.getTypeName().getString());
+				hashString(attributeData.getText().getString());
+			}
+		}
+	}
+
+	for(const auto& [nodesIndexes, edgeHandle] : edgesByNodesIndex)
+	{
+		hashString(std::to_string(nodesIndexes.first) + ">" + std::to_string(nodesIndexes.second));
+		std::map<std::string, std::string> sortedAttributes;
+		for(const auto& [attributeName, attributeValue] : edges[edgeHandle].attributes)
+		{
+			sortedAttributes.emplace(attributeName.getString(), attributeValue.getString());
+		}
+		for(const auto& [attributeName, attributeValue] : sortedAttributes)
+		{
+			hashString(attributeName);
+			hashString(attributeValue);
+		}
+	}
+	return hash;
+}
+
+const std::vector<GraphOperation>& Graph::getOperations() const
+{
+	return operations;
+}
+
+const GraphSnapshot* Graph::getSnapshot() const
+{
+	return snapshot && snapshot->getVersion() == version ? snapshot.get() : nullptr;
+}
+
+const MatchPlan* Graph::getMatchPlan() const
+{
+	return matchPlan.searchedGraphVersion == version ? &matchPlan : nullptr;
+}
+
+MatchPlan Graph::createMatchPlan(const Graph* inStatisticsGraph, const int inFirstNodeIndex) const
+{
+	//Estimated number of candidates of each node, the lower the sooner it should be mapped
+	std::vector<double> candidatesEstimates(nodeCount, 0.);
+	for(int nodeIndex = 0; nodeIndex < nodeCount; ++nodeIndex)
+	{
+		const auto* node = getNodeByIndex(nodeIndex);
+		if(!node)
+		{
+			continue; //A missing node has no candidate at all
+		}
+
+		if(!inStatisticsGraph) //Without statistics, each attribute is assumed to divide the candidates
+		{
+			candidatesEstimates[nodeIndex] = 1. / static_cast<double>(1 + node->attributes.size());
+			continue;
+		}
+
+		const std::vector<int>* nodesIndexes = nullptr;
+		for(const auto& [attributeName, attributeData] : node->attributes)
+		{
+			const auto& attributeNodesIndexes = attributeName == Symbols::TARGET || attributeData.getText() == Symbols::NOT_AVAILABLE //TODO make virtual method for story nodes after template hell is done
+				? inStatisticsGraph->getNodesIndexesWithAttribute(attributeName)
+				: inStatisticsGraph->getNodesIndexesWithAttribute(attributeName, attributeData.getText());
+			if(!nodesIndexes || attributeNodesIndexes.size() < nodesIndexes->size())
+			{
+				nodesIndexes = &attributeNodesIndexes;
+			}
+		}
+
+		const auto hasEnoughEdges = [inStatisticsGraph, node](const int inNodeIndex)
+		{
+			const auto* statisticsNode = inStatisticsGraph->getNodeByIndex(inNodeIndex);
+			return statisticsNode && statisticsNode->incomingEdges.size() >= node->incomingEdges.size() && statisticsNode->outgoingEdges.size() >= node->outgoingEdges.size();
+		};
+		if(nodesIndexes)
+		{
+			candidatesEstimates[nodeIndex] = static_cast<double>(std::ranges::count_if(*nodesIndexes, hasEnoughEdges));
+		}
+		else
+		{
+			for(int statisticsNodeIndex = 0; statisticsNodeIndex < inStatisticsGraph->nodeCount; ++statisticsNodeIndex)
+			{
+				candidatesEstimates[nodeIndex] += hasEnoughEdges(statisticsNodeIndex) ? 1. : 0.;
+			}
+		}
+	}
+
+	//Greedily pick the node most connected to the already planned ones, so that each step is constrained by adjacency, then the most selective, then the most connected overall
+	MatchPlan plan;
+	plan.searchedGraphVersion = version;
+	std::vector<int> connectionsToPlannedNodes(nodeCount, 0);
+	std::vector<bool> isPlanned(nodeCount, false);
+	const auto degree = [this](const int inNodeIndex)
+	{
+		return static_cast<int>(BitMatrix::count(adjacencyList.getRow(inNodeIndex), adjacencyList.getWordsPerRow()) + BitMatrix::count(incomingAdjacencyList.getRow(inNodeIndex), incomingAdjacencyList.getWordsPerRow()));
+	};
+	for(int step = 0; step < nodeCount; ++step)
+	{
+		int nextNodeIndex = NONE;
+		for(int nodeIndex = 0; nodeIndex < nodeCount; ++nodeIndex)
+		{
+			if(isPlanned[nodeIndex])
+			{
+				continue;
+			}
+			if(nextNodeIndex == NONE || nodeIndex == inFirstNodeIndex)
+			{
+				nextNodeIndex = nodeIndex;
+				continue;
+			}
+
+			if
+			(
+				nextNodeIndex != inFirstNodeIndex
+				&& std::tuple(-connectionsToPlannedNodes[nodeIndex], candidatesEstimates[nodeIndex], -degree(nodeIndex))
+					< std::tuple(-connectionsToPlannedNodes[nextNodeIndex], candidatesEstimates[nextNodeIndex], -degree(nextNodeIndex))
+			)
+			{
+				nextNodeIndex = nodeIndex;
+			}
+		}
+
+		isPlanned[nextNodeIndex] = true;
+		auto& edgeChecks = plan.edgeChecks.emplace_back();
+		for(int plannedStep = 0; plannedStep < step; ++plannedStep)
+		{
+			const auto plannedNodeIndex = plan.nodesIndexes[plannedStep];
+			if(adjacencyList.at(nextNodeIndex, plannedNodeIndex))
+			{
+				edgeChecks.emplace_back(MatchPlan::EdgeCheck{plannedStep, true, edgesByNodesIndex.at({nextNodeIndex, plannedNodeIndex})});
+			}
+			if(adjacencyList.at(plannedNodeIndex, nextNodeIndex))
+			{
+				edgeChecks.emplace_back(MatchPlan::EdgeCheck{plannedStep, false, edgesByNodesIndex.at({plannedNodeIndex, nextNodeIndex})});
+			}
+		}
+		plan.nodesIndexes.emplace_back(nextNodeIndex);
+
+		for(int nodeIndex = 0; nodeIndex < nodeCount; ++nodeIndex)
+		{
+			connectionsToPlannedNodes[nodeIndex] += (adjacencyList.at(nodeIndex, nextNodeIndex) ? 1 : 0) + (adjacencyList.at(nextNodeIndex, nodeIndex) ? 1 : 0);
+		}
+	}
+	return plan;
+}
+
+const std::vector<int>& Graph::getNodesIndexesWithAttribute(const Symbol inAttributeName) const
+{
+	static const std::vector<int> noNodesIndexes;
+	const auto nodesIndexes = nodesIndexesByAttributeName.find(inAttributeName);
+	return nodesIndexes != nodesIndexesByAttributeName.end() ? nodesIndexes->second : noNodesIndexes;
+}
+
+const std::vector<int>& Graph::getNodesIndexesWithAttribute(const Symbol inAttributeName, const Symbol inAttributeValue) const
+{
+	static const std::vector<int> noNodesIndexes;
+	if(const auto attributeValues = nodesIndexesByAttribute.find(inAttributeName); attributeValues != nodesIndexesByAttribute.end())
+	{
+		if(const auto nodesIndexes = attributeValues->second.find(inAttributeValue); nodesIndexes != attributeValues->second.end())
+		{
+			return nodesIndexes->second;
+		}
+	}
+	return noNodesIndexes;
+}
+
+bool Graph::loadFromXml(const std::string& inPath)
+{
+	//Streamed rather than parsed into a document first, each node is added as soon as its element ends so that loading holds little more than the graph itself
+	XmlStreamReader reader(inPath);
+	if(!reader.isOpen())
+	{
+		std::cerr << inPath << ": can't be opened" << std::endl;
+		return false;
+	}
+
+	std::string nodeName;
+	NodeAttributes nodeAttributes;
+	std::string attributeName;
+	std::string attributeTypeName;
+	std::string attributeText;
+	bool bIsInAttribute = false;
+	bool bHasAttributeText = false;
+	std::string connectionSource;
+	std::string connectionTarget;
+	std::vector<std::tuple<std::pair<Symbol, Symbol>, Symbol, Symbol> > pendingEdges; //Relations met before the nodes they connect
+	for(auto event = reader.next(); event != XmlStreamReader::Event::EndOfDocument; event = reader.next())
+	{
+		const auto& elementName = reader.getName();
+		if(event == XmlStreamReader::Event::Error)
+		{
+			std::cerr << inPath << ": " << reader.getError() << std::endl;
+			return false;
+		}
+		if(event == XmlStreamReader::Event::StartElement)
+		{
+			if(elementName == "graph")
+			{
+				name = reader.getAttribute("name");
+				type = reader.getAttribute("type");
+			}
+			else if(elementName == "node")
+			{
+				nodeName = reader.getAttribute("name");
+			}
+			else if(elementName == "attr")
+			{
+				attributeName = reader.getAttribute("name");
+				attributeTypeName = reader.getAttribute("type");
+				attributeText.clear();
+				bIsInAttribute = true;
+				bHasAttributeText = false;
+			}
+			else if(elementName == "connection")
+			{
+				connectionSource = reader.getAttribute("from");
+				connectionTarget = reader.getAttribute("to");
+			}
+			else if(elementName == "relation" && reader.getAttributeCount() > 0)
+			{
+				const auto& [relationName, relationValue] = reader.getAttribute(0);
+				std::pair<Symbol, Symbol> edgeAttribute{relationName, relationValue};
+				if(const Symbol sourceName(connectionSource), targetName(connectionTarget); nodesByName.contains(sourceName) && nodesByName.contains(targetName))
+				{
+					addEdge(std::move(edgeAttribute), sourceName, targetName);
+				}
+				else
+				{
+					pendingEdges.emplace_back(std::move(edgeAttribute), sourceName, targetName);
+				}
+			}
+		}
+		else if(event == XmlStreamReader::Event::Text)
+		{
+			if(bIsInAttribute && !bHasAttributeText) //The value is the text of the first child of the attribute
+			{
+				attributeText = reader.getText();
+				bHasAttributeText = true;
+			}
+		}
+		else if(elementName == "attr")
+		{
+			nodeAttributes.insert({attributeName, NodeAttribute{attributeTypeName, attributeText}});
+			bIsInAttribute = false;
+		}
+		else if(elementName == "node")
+		{
+			addNode(Node(nodeName, std::move(nodeAttributes)));
+			nodeAttributes = NodeAttributes();
+		}
+	}
+
+	for(auto& [edgeAttribute, sourceName, targetName] : pendingEdges)
+	{
+		if(!nodesByName.contains(sourceName) || !nodesByName.contains(targetName))
+		{
+			std::cerr << inPath << ": connection from " << sourceName.getString() << " to " << targetName.getString() << " names a missing node" << std::endl;
+			return false;
+		}
+		addEdge(std::move(edgeAttribute), sourceName, targetName);
+	}
+	operations.clear(); //The loaded graph is the baseline later modifications are relative to
+	return true;
 }
 
-void Graph::loadFromXml(const std::string& inPath)
+void Graph::createSnapshot()
 {
-	pugi::xml_document document;
-	document.load_file(inPath.c_str());
-	const auto& parsedXml = document.document_element();
+	snapshot = std::make_shared<const GraphSnapshot>(*this);
+}
 
-	loadFromXml(parsedXml);
+void Graph::compileMatchPlan(const Graph* inStatisticsGraph)
+{
+	matchPlan = createMatchPlan(inStatisticsGraph);
 }
 
 void Graph::loadFromXml(const pugi::xml_node& inParsedXml)
@@ -311,14 +652,15 @@ void Graph::loadFromXml(const pugi::xml_node& inParsedXml)
 	type = inParsedXml.attribute("type").as_string();
 
 	const auto parsedNodeCount = std::distance(inParsedXml.child("nodes").children().begin(), inParsedXml.child("nodes").children().end());
-	adjacencyList = arma::mat(parsedNodeCount, parsedNodeCount, arma::fill::zeros);
+	adjacencyList = BitMatrix(parsedNodeCount, parsedNodeCount);
+	incomingAdjacencyList = BitMatrix(parsedNodeCount, parsedNodeCount);
 	
 	for(const auto& node : inParsedXml.child("nodes").children())
 	{
-		std::unordered_map<std::string, NodeAttribute> nodeAttributes;
+		NodeAttributes nodeAttributes;
+		nodeAttributes.reserve(std::distance(node.children("attr").begin(), node.children("attr").end()));
 		for(const auto& nodeAttribute : node.children("attr"))
 		{
-			const auto attributeName = std::string();
 			nodeAttributes.insert
 			({
 				nodeAttribute.attribute("name").as_string(),
@@ -332,17 +674,15 @@ void Graph::loadFromXml(const pugi::xml_node& inParsedXml)
 		
 		addNode
 		(
-			new Node
+			Node
 			(
 				node.attribute("name").as_string(),
-				nodeAttributes
+				std::move(nodeAttributes)
 			)
 		);
 	}
 	for(const auto& connection : inParsedXml.child("connections").children())
 	{
-		std::unordered_map<std::string, std::string> edgeAttributes;
-
 		for(const auto& attribute : connection.children("relation"))
 		{
 			addEdge
@@ -357,96 +697,269 @@ void Graph::loadFromXml(const pugi::xml_node& inParsedXml)
 		}
 		
 	}
+	operations.clear(); //The loaded graph is the baseline later modifications are relative to
 }
 
-std::shared_ptr<Node> Graph::addNode(Node* inNode)
+void Graph::loadFromBundle(BundleReader& ioReader)
 {
-	inNode->index = nodeCount;
-	
-	std::shared_ptr<Node> newNode(inNode);
-	nodesByName[inNode->name] = newNode;
-	nodesByIndex[nodeCount] = newNode;
+	name = ioReader.readString();
+	type = ioReader.readString();
+
+	//A failed reader is left for the caller to check, the graph is then discarded
+	const auto readNodeCount = static_cast<int>(ioReader.readCount(sizeof(uint32_t) * 2));
+	adjacencyList = BitMatrix(readNodeCount, readNodeCount);
+	incomingAdjacencyList = BitMatrix(readNodeCount, readNodeCount);
+	for(int nodeIndex = 0; nodeIndex < readNodeCount; ++nodeIndex)
+	{
+		const auto nodeName = ioReader.readSymbol();
+		const auto attributeCount = ioReader.readCount(sizeof(uint32_t) * 3);
+		NodeAttributes nodeAttributes;
+		nodeAttributes.reserve(attributeCount);
+		for(uint32_t attributeIndex = 0; attributeIndex < attributeCount; ++attributeIndex)
+		{
+			const auto attributeName = ioReader.readSymbol();
+			const auto attributeTypeName = ioReader.readSymbol();
+			nodeAttributes.insert({attributeName, NodeAttribute(attributeTypeName, ioReader.readSymbol())});
+		}
+		if(ioReader.hasFailed())
+		{
+			return;
+		}
+		addNode(Node(nodeName, std::move(nodeAttributes)));
+	}
 
-	++nodeCount;
-	if(const auto size = static_cast<size_t>(nodeCount); adjacencyList.n_rows < size)
+	const auto readEdgeCount = static_cast<int>(ioReader.readCount(sizeof(uint32_t) * 3));
+	for(int edgeHandle = 0; edgeHandle < readEdgeCount; ++edgeHandle)
+	{
+		const auto sourceIndex = ioReader.read<int32_t>();
+		const auto targetIndex = ioReader.read<int32_t>();
+		if(sourceIndex < 0 || sourceIndex >= readNodeCount || targetIndex < 0 || targetIndex >= readNodeCount)
+		{
+			ioReader.fail();
+			return;
+		}
+		const auto attributeCount = ioReader.readCount(sizeof(uint32_t) * 2);
+		for(uint32_t attributeIndex = 0; attributeIndex < attributeCount; ++attributeIndex)
+		{
+			const auto attributeName = ioReader.readSymbol();
+			addEdge({attributeName, ioReader.readSymbol()}, sourceIndex, targetIndex);
+		}
+	}
+	operations.clear(); //The loaded graph is the baseline later modifications are relative to
+}
+
+void Graph::saveToBundle(BundleWriter& ioWriter) const
+{
+	assert(nodes.getSize() == nodeCount && edges.getSize() == edges.getHandleCount());
+	ioWriter.writeString(name);
+	ioWriter.writeString(type);
+
+	ioWriter.write(static_cast<int32_t>(nodeCount));
+	for(int nodeIndex = 0; nodeIndex < nodeCount; ++nodeIndex)
+	{
+		const auto& node = nodes[nodeIndex];
+		ioWriter.writeSymbol(node.name);
+		ioWriter.write(static_cast<uint32_t>(node.attributes.size()));
+		for(const auto& [attributeName, attributeData] : node.attributes)
+		{
+			ioWriter.writeSymbol(attributeName);
+			ioWriter.writeSymbol(attributeData.getTypeName());
+			ioWriter.writeSymbol(attributeData.getText());
+		}
+	}
+
+	ioWriter.write(static_cast<int32_t>(edges.getHandleCount()));
+	for(int edgeHandle = 0; edgeHandle < edges.getHandleCount(); ++edgeHandle)
+	{
+		const auto& edge = edges[edgeHandle];
+		ioWriter.write(static_cast<int32_t>(edge.sourceIndex));
+		ioWriter.write(static_cast<int32_t>(edge.targetIndex));
+		ioWriter.write(static_cast<uint32_t>(edge.attributes.size()));
+		for(const auto& [attributeName, attributeValue] : edge.attributes)
+		{
+			ioWriter.writeSymbol(attributeName);
+			ioWriter.writeSymbol(attributeValue);
+		}
+	}
+}
+
+Node& Graph::addNode(Node inNode)
+{
+	inNode.incomingEdges.clear();
+	inNode.outgoingEdges.clear();
+	const auto nodeIndex = nodes.create(std::move(inNode));
+	auto& newNode = nodes[nodeIndex];
+	newNode.index = nodeIndex;
+
+	nodesByName[newNode.name] = nodeIndex;
+	for(const auto& [attributeName, attributeData] : newNode.attributes)
+	{
+		indexNodeAttribute(nodeIndex, attributeName, attributeData.getText());
+	}
+
+	operations.push_back({GraphOperationType::AddNode, nodeIndex, NONE});
+	if(bIsInTransaction)
+	{
+		undoLog.emplace_back(GraphUndoRecord::Type::AddNode, nodeIndex);
+	}
+	nodeCount = nodes.getHandleCount();
+	++version;
+	if(const auto size = static_cast<size_t>(nodeCount); adjacencyList.getRowCount() < size)
 	{
 		adjacencyList.resize(size, size);
+		incomingAdjacencyList.resize(size, size);
 	}
 
 	return newNode;
 }
 
-void Graph::removeNode(const std::shared_ptr<Node> inNodeToRemove) const
+void Graph::removeNode(const int inNodeIndex)
 {
-	nodesByName.erase(inNodeToRemove->getName());
+	auto& nodeToRemove = nodes[inNodeIndex];
+	while(!nodeToRemove.incomingEdges.empty())
+	{
+		removeEdge(edges[nodeToRemove.incomingEdges.back()].sourceIndex, inNodeIndex);
+	}
+	while(!nodeToRemove.outgoingEdges.empty())
+	{
+		removeEdge(inNodeIndex, edges[nodeToRemove.outgoingEdges.back()].targetIndex);
+	}
+
+	nodesByName.erase(nodeToRemove.name);
+	++version;
+	operations.push_back({GraphOperationType::RemoveNode, inNodeIndex, NONE});
+	for(const auto& [attributeName, attributeData] : nodeToRemove.attributes)
+	{
+		unindexNodeAttribute(inNodeIndex, attributeName, attributeData.getText());
+	}
+	if(bIsInTransaction)
+	{
+		auto& undoRecord = undoLog.emplace_back(GraphUndoRecord::Type::RemoveNode, inNodeIndex);
+		undoRecord.removedNode = std::move(nodeToRemove);
+	}
+	nodes.destroy(inNodeIndex);
+}
 
-	if(nodesByIndex.contains(inNodeToRemove->getIndex()))
+void Graph::setNodeAttribute(Node& ioNode, const Symbol inAttributeName, const NodeAttribute& inAttributeValue)
+{
+	const auto previousAttribute = ioNode.attributes.find(inAttributeName);
+	if(previousAttribute != ioNode.attributes.end())
+	{
+		unindexNodeAttribute(ioNode.index, inAttributeName, previousAttribute->second.getText());
+	}
+	if(bIsInTransaction)
 	{
-		nodesByIndex[inNodeToRemove->getIndex()].reset();
+		auto& undoRecord = undoLog.emplace_back(GraphUndoRecord::Type::SetNodeAttribute, ioNode.index);
+		undoRecord.attributeName = inAttributeName;
+		if(previousAttribute != ioNode.attributes.end())
+		{
+			undoRecord.previousAttribute = previousAttribute->second;
+		}
 	}
+	ioNode.setAttribute(inAttributeName, inAttributeValue);
+	indexNodeAttribute(ioNode.index, inAttributeName, inAttributeValue.getText());
+	++version;
+	operations.push_back({GraphOperationType::SetNodeAttribute, ioNode.index, NONE});
 }
 
-void Graph::addEdge(std::pair<std::string, std::string> inEdgeAttribute, std::shared_ptr<Node> inSourceNode, std::shared_ptr<Node> inTargetNode)
+void Graph::addEdge(std::pair<Symbol, Symbol> inEdgeAttribute, const int inSourceIndex, const int inTargetIndex)
 {
-	assert(inSourceNode.get() != inTargetNode.get());
-	auto edge = edgesByNodesNames[{inSourceNode->name, inTargetNode->name}];
-	if(!edge)
+	assert(inSourceIndex != inTargetIndex);
+	auto& sourceNode = nodes[inSourceIndex];
+	auto& targetNode = nodes[inTargetIndex];
+	auto [edgeHandle, bIsNewEdge] = edgesByNodesIndex.try_emplace({inSourceIndex, inTargetIndex}, NONE);
+	if(bIsNewEdge)
 	{	
-		edge.reset(new Edge());
+		edgeHandle->second = edges.create(inSourceIndex, inTargetIndex, EdgeAttributes());
 
-		inSourceNode->outgoingEdges.emplace_back(edge);
-		inTargetNode->incomingEdges.emplace_back(edge);
+		sourceNode.outgoingEdges.emplace_back(edgeHandle->second);
+		targetNode.incomingEdges.emplace_back(edgeHandle->second);
+		edgesByNodesNames[{sourceNode.name, targetNode.name}] = edgeHandle->second;
 		
-		edgesByNodesNames[{inSourceNode->name, inTargetNode->name}] = edge;
-		
-		const size_t sourceNodeIndex = inSourceNode->index;
-		const size_t targetNodeIndex = inTargetNode->index;
-		adjacencyList.at(sourceNodeIndex, targetNodeIndex) = 1;
-		edgesByNodesIndex[{static_cast<int>(sourceNodeIndex), static_cast<int>(targetNodeIndex)}] = edge;
-
-		edge->sourceNode = std::move(inSourceNode);
-		edge->targetNode = std::move(inTargetNode);	
-		
-		++edgeCount;
+		adjacencyList.set(inSourceIndex, inTargetIndex);
+		incomingAdjacencyList.set(inTargetIndex, inSourceIndex);
+	}
+	const auto attributeName = inEdgeAttribute.first;
+	const auto bIsNewAttribute = edges[edgeHandle->second].attributes.insert(std::move(inEdgeAttribute)).second;
+	++version;
+	operations.push_back({GraphOperationType::AddEdge, inSourceIndex, inTargetIndex});
+	if(bIsInTransaction)
+	{
+		auto& undoRecord = undoLog.emplace_back(GraphUndoRecord::Type::AddEdge, inSourceIndex, inTargetIndex, edgeHandle->second);
+		undoRecord.attributeName = attributeName;
+		undoRecord.bCreatedEdge = bIsNewEdge;
+		undoRecord.bInsertedEdgeAttribute = bIsNewAttribute;
 	}
-	edge->attributes.insert(std::move(inEdgeAttribute));
 }
 
-void Graph::addEdge(std::pair<std::string, std::string>&& inEdgeAttribute, const int inSourceIndex, const int inTargetIndex)
+void Graph::addEdge(std::pair<Symbol, Symbol> inEdgeAttribute, const Symbol inSourceNodeName, const Symbol inTargetNodeName)
 {
-	addEdge(inEdgeAttribute, nodesByIndex.at(inSourceIndex), nodesByIndex.at(inTargetIndex));
+	addEdge(std::move(inEdgeAttribute), nodesByName.at(inSourceNodeName), nodesByName.at(inTargetNodeName));
 }
 
-void Graph::addEdge(std::pair<std::string, std::string>&& inEdgeAttribute, const std::string& inSourceNodeName, const std::string& inTargetNodeName)
+void Graph::removeEdge(const int inSourceIndex, const int inTargetIndex)
 {
-	addEdge(inEdgeAttribute, nodesByName.at(inSourceNodeName), nodesByName.at(inTargetNodeName));
+	auto& sourceNode = nodes[inSourceIndex];
+	auto& targetNode = nodes[inTargetIndex];
+	const auto edgeHandle = edgesByNodesIndex.at({inSourceIndex, inTargetIndex});
+	++version;
+	operations.push_back({GraphOperationType::RemoveEdge, inSourceIndex, inTargetIndex});
+
+	adjacencyList.reset(inSourceIndex, inTargetIndex);
+	incomingAdjacencyList.reset(inTargetIndex, inSourceIndex);
+	edgesByNodesIndex.erase({inSourceIndex, inTargetIndex});
+	edgesByNodesNames.erase({sourceNode.name, targetNode.name});
+
+	const auto outgoingEdge = std::ranges::find(sourceNode.outgoingEdges, edgeHandle);
+	const auto incomingEdge = std::ranges::find(targetNode.incomingEdges, edgeHandle);
+	if(bIsInTransaction)
+	{
+		auto& undoRecord = undoLog.emplace_back(GraphUndoRecord::Type::RemoveEdge, inSourceIndex, inTargetIndex, edgeHandle);
+		undoRecord.removedEdge = std::move(edges[edgeHandle]);
+		undoRecord.outgoingEdgePosition = outgoingEdge - sourceNode.outgoingEdges.begin();
+		undoRecord.incomingEdgePosition = incomingEdge - targetNode.incomingEdges.begin();
+	}
+	sourceNode.outgoingEdges.erase(outgoingEdge);
+	targetNode.incomingEdges.erase(incomingEdge);
+	edges.destroy(edgeHandle);
 }
 
-void Graph::removeEdge(const std::shared_ptr<Edge> inEdge)
+void Graph::removeEdge(const Symbol inSourceNodeName, const Symbol inTargetNodeName)
 {
-	const auto sourceNode = inEdge->getSourceNode();
-	const auto targetNode = inEdge->getTargetNode();
-
-	adjacencyList.at(sourceNode->getIndex(), targetNode->getIndex()) = 0;
-	edgesByNodesIndex.erase({sourceNode->getIndex(), targetNode->getIndex()});
-	edgesByNodesNames.erase({sourceNode->getName(), targetNode->getName()});
-
-	const auto isSameEdgePredicate = [inEdge](const std::shared_ptr<Edge>& element){return element.get() == inEdge.get();};
-	sourceNode->outgoingEdges.remove_if(isSameEdgePredicate);
-	targetNode->incomingEdges.remove_if(isSameEdgePredicate);
+	removeEdge(nodesByName.at(inSourceNodeName), nodesByName.at(inTargetNodeName));
 }
 
-void Graph::removeEdge(const int inSourceIndex, const int inTargetIndex)
+void Graph::indexNodeAttribute(const int inNodeIndex, const Symbol inAttributeName, const Symbol inAttributeValue)
 {
-	removeEdge(edgesByNodesIndex.at({inSourceIndex, inTargetIndex}));
+	const auto insertSorted = [inNodeIndex](std::vector<int>& ioNodesIndexes)
+	{
+		if(ioNodesIndexes.empty() || ioNodesIndexes.back() < inNodeIndex) //Nodes are mostly indexed as they are added, hence in increasing order
+		{
+			ioNodesIndexes.emplace_back(inNodeIndex);
+		}
+		else if(const auto position = std::ranges::lower_bound(ioNodesIndexes, inNodeIndex); *position != inNodeIndex)
+		{
+			ioNodesIndexes.insert(position, inNodeIndex);
+		}
+	};
+	insertSorted(nodesIndexesByAttributeName[inAttributeName]);
+	insertSorted(nodesIndexesByAttribute[inAttributeName][inAttributeValue]);
 }
 
-void Graph::removeEdge(const std::string& inSourceNodeName, const std::string& inTargetNodeName)
+void Graph::unindexNodeAttribute(const int inNodeIndex, const Symbol inAttributeName, const Symbol inAttributeValue)
 {
-	removeEdge(edgesByNodesNames.at({inSourceNodeName, inTargetNodeName}));
+	const auto eraseSorted = [inNodeIndex](std::vector<int>& ioNodesIndexes)
+	{
+		if(const auto position = std::ranges::lower_bound(ioNodesIndexes, inNodeIndex); position != ioNodesIndexes.end() && *position == inNodeIndex)
+		{
+			ioNodesIndexes.erase(position);
+		}
+	};
+	eraseSorted(nodesIndexesByAttributeName[inAttributeName]);
+	eraseSorted(nodesIndexesByAttribute[inAttributeName][inAttributeValue]);
 }
 
-void Graph::saveAsDotFile(const std::string& inColor, const std::string& inFontColor, const std::string& inOutputPath, const bool inLogAdjacencyMatrix) const
+std::string Graph::saveAsDotFile(const std::string& inColor, const std::string& inFontColor, const std::string& inOutputPath, const bool inLogAdjacencyMatrix) const
 {
 	if(!std::filesystem::exists(inOutputPath))
 	{
@@ -454,224 +967,395 @@ void Graph::saveAsDotFile(const std::string& inColor, const std::string& inFontC
 	}
 	assert(!std::filesystem::is_regular_file(inOutputPath));
 	
-	const auto fullPathWithoutExtension = inOutputPath + "/" + name;
-	const auto dotFilePath = fullPathWithoutExtension + ".dot";
+	const auto dotFilePath = inOutputPath + "/" + name + ".dot";
 	if(std::ofstream file(dotFilePath, std::ios::out | std::ios::trunc); file)
 	{
 		file << "digraph " << name << " {" << std::endl << "node [shape = \"record\"]" << std::endl;
 
-		for(const auto& [name, node] : nodesByName)
+		for(int nodeIndex = 0; nodeIndex < nodeCount; ++nodeIndex) //In index order, the order of the names would depend on the symbols ids, hence on the order in which concurrently generated stories interned them
 		{
-			file << name <<  "[label=\"{" << name << "|";
+			const auto* node = getNodeByIndex(nodeIndex);
+			if(!node)
+			{
+				continue;
+			}
+			file << node->getName() <<  "[label=\"{" << node->getName() << "|";
 			for(const auto& [name, nodeAttribute] : node->attributes)
 			{
-				file << name << "=" << nodeAttribute.value << "\\l";  
+				file << name.getString() << "=" << nodeAttribute.getText().getString() << "\\l";  
 			}
 			file << "}\"] [color=" << inColor << " fontcolor=" << inFontColor << "]" << std::endl;
 			
 		}
 		
-		for(auto j = 0; j < nodeCount; ++j)
+#ifndef NDEBUG
+		if(inLogAdjacencyMatrix)
 		{
-			for(auto i = 0; i < nodeCount; ++i)
+			for(auto j = 0; j < nodeCount; ++j)
 			{
-				const auto edge = edgesByNodesIndex[std::pair{i, j}];
-#ifndef NDEBUG
-				if(inLogAdjacencyMatrix)
+				for(auto i = 0; i < nodeCount; ++i)
 				{
-					PRINT(edge);
+					PRINT(edgesByNodesIndex.contains(std::pair{i, j}));
 				}
+				PRINTLN("");
+			}
+		}
 #endif
-				if(edge)
+
+		//Edges by target then source index, the order the adjacency matrix was once read in, but reaching only the existing edges
+		std::vector<std::pair<int, int> > incomingEdges; //Source index and handle of each edge coming into the current target
+		for(int targetIndex = 0; targetIndex < nodeCount; ++targetIndex)
+		{
+			const auto* targetNode = getNodeByIndex(targetIndex);
+			if(!targetNode)
+			{
+				continue;
+			}
+			incomingEdges.clear();
+			for(const auto edgeHandle : targetNode->incomingEdges)
+			{
+				incomingEdges.emplace_back(edges[edgeHandle].sourceIndex, edgeHandle);
+			}
+			std::ranges::sort(incomingEdges);
+			for(const auto& [sourceIndex, edgeHandle] : incomingEdges)
+			{
+				for(const auto& [attribute, value] : edges[edgeHandle].attributes)
 				{
-					for(const auto& [attribute, value] : edge->attributes)
+					file << nodes[sourceIndex].getName() << " -> " << targetNode->getName();
+					if (attribute.getString() != "none")
 					{
-						file << edge->sourceNode->name << " -> " << edge->targetNode->name;
-						if (attribute != "none")
-						{
-							file << " [label=" << "\"{'" << attribute << "' : '" << value << "'}\"] [color=" << inColor << " fontcolor=" << inFontColor << "]"; 
-						}
-						file << std::endl;
+						file << " [label=" << "\"{'" << attribute.getString() << "' : '" << value.getString() << "'}\"] [color=" << inColor << " fontcolor=" << inFontColor << "]"; 
 					}
+					file << std::endl;
 				}
 			}
-#ifndef NDEBUG
-			if(inLogAdjacencyMatrix)
-			{
-				PRINTLN("");
-			}
-#endif
 		}
 		file << "}";
-		file.close();
-		system(("dot -Tpng " + dotFilePath + " -o " + fullPathWithoutExtension + ".png").c_str()); //TODO move outside to enable multi-threading
-		return;
+		return dotFilePath;
 	}
 	assert(false);
+	return dotFilePath;
+}
+
+
+void Graph::getIsomorphicSubGraphs(const Graph& inSearchedGraph, std::list<std::list<const Node*>>& outFoundSubNodes, const int inMaxCount) const
+{
+	SubGraphMatcher matcher(*this, inSearchedGraph);
+	for(int count = 0; (inMaxCount == NONE || count < inMaxCount) && matcher.next(); ++count)
+	{
+		std::list<const Node*> foundSubNodes;
+		matcher.getSubNodes(foundSubNodes);
+		outFoundSubNodes.emplace_back(std::move(foundSubNodes));
+	}
 }
 
+bool Graph::hasIsomorphicSubGraph(const Graph& inSearchedGraph) const
+{
+	return SubGraphMatcher(*this, inSearchedGraph).next();
+}
 
-void Graph::getIsomorphicSubGraphs(const Graph& inSearchedGraph, std::list<std::list<std::shared_ptr<Node>>>& outFoundSubNodes) const
+void Graph::getRandomIsomorphicSubGraphs(const Graph& inSearchedGraph, const int inCount, std::default_random_engine& inRandomEngine, std::list<std::list<const Node*>>& outFoundSubNodes) const
 {
-	//Find subNodes for each nodes of searched graph
-	arma::mat m(inSearchedGraph.nodeCount, nodeCount, arma::fill::zeros);
-	for(int row = 0; row < inSearchedGraph.nodeCount; ++row)
+	//Reservoir sampling, so that only inCount mappings are kept whatever the number of subgraphs found
+	std::vector<std::vector<int> > sampledMappings;
+	sampledMappings.reserve(inCount);
+	SubGraphMatcher matcher(*this, inSearchedGraph);
+	for(int foundCount = 0; matcher.next(); ++foundCount)
 	{
-		for(int col = 0; col < nodeCount; ++col)
+		if(foundCount < inCount)
 		{
-			if(const auto node = nodesByIndex.at(col), subNode = inSearchedGraph.nodesByIndex.at(row); node && subNode && node->incomingEdges.size() >= subNode->incomingEdges.size()
-				&& node->outgoingEdges.size() >= subNode->outgoingEdges.size()
-				&& node->isSubNode(*subNode))
-			{
-				m.at(row,col) = 1;
-			}		
+			sampledMappings.emplace_back(matcher.getMapping());
+		}
+		else if(const auto replacedIndex = std::uniform_int_distribution{0, foundCount}(inRandomEngine); replacedIndex < inCount)
+		{
+			sampledMappings[replacedIndex] = matcher.getMapping();
 		}
 	}
 
-	//List found subNodesIndexes by searchedNodeIndexes
-	std::vector<std::vector<int> > subNodesIndexes;
-	subNodesIndexes.resize(inSearchedGraph.nodeCount);
-	for(int row = 0; row < inSearchedGraph.nodeCount; ++row)
+	for(const auto& sampledMapping : sampledMappings)
 	{
-		subNodesIndexes[row].reserve(nodeCount);
-		for(int col = 0; col < nodeCount; ++col)
+		std::list<const Node*> foundSubNodes;
+		for(const auto nodeIndex : sampledMapping)
 		{
-			if(static_cast<int>(m.at(row,col)))
-			{
-				subNodesIndexes[row].emplace_back(col);
-			}
+			foundSubNodes.emplace_back(getNodeByIndex(nodeIndex));
 		}
+		outFoundSubNodes.emplace_back(std::move(foundSubNodes));
 	}
+}
 
-	//Create all singleton combinations of subNodes
-	std::vector<std::vector<int> > nodesCombinations;
-	if(subNodesIndexes.size() > 1)
+bool Graph::containsEdges(const std::vector<int>& inEdges, const Graph& inParentGraph, const std::vector<int>& inParentEdges) const
+{
+	std::vector<bool> foundEdges(inEdges.size(), false);
+	for(const auto parentEdge : inParentEdges) //For each edges from parent node
 	{
-		nodesCombinations = Math::customCartesianProduct(subNodesIndexes[0], subNodesIndexes[1]);
-		for(auto i = 2; i < inSearchedGraph.nodeCount; ++i)
+		bool containsEdge = false;
+		for(size_t position = 0; position < inEdges.size() && !containsEdge; ++position) //We take the first edge from main node that hasn't yet been set as a sub-edge and holds one of the parent edge attributes
+		{
+			if(!foundEdges[position] && edges[inEdges[position]].containsAttribute(inParentGraph.edges[parentEdge]))
+			{
+				foundEdges[position] = true;
+				containsEdge = true;
+			}
+		}
+		if(!containsEdge) //Then the edges of the main node are not sub-edges of the parentNode
 		{
-			nodesCombinations = Math::customCartesianProduct(subNodesIndexes[i], nodesCombinations);
+			return false;
 		}
 	}
-	else if(subNodesIndexes.size() == 1)
+	return true; //Else they are
+}
+
+void Graph::validateNode(const int inNodeIndex)
+{
+	//Only the nodes inNodeIndex can be reached from are validated, each waits for its successors among them to be validated first
+	std::vector<int> remainingSuccessorsCounts(nodeCount, NONE);
+	std::vector<int> upstreamPositions(nodeCount, NONE);
+	std::vector<int> upstreamNodesIndexes{inNodeIndex};
+	remainingSuccessorsCounts[inNodeIndex] = 0;
+	upstreamPositions[inNodeIndex] = 0;
+	for(size_t position = 0; position < upstreamNodesIndexes.size(); ++position)
 	{
-		for(const auto& subNodeIndex : subNodesIndexes[0])
+		for(const auto incomingEdge : nodes[upstreamNodesIndexes[position]].incomingEdges)
 		{
-			nodesCombinations.emplace_back(std::vector{subNodeIndex});	
+			const auto sourceIndex = edges[incomingEdge].sourceIndex;
+			if(remainingSuccessorsCounts[sourceIndex] == NONE)
+			{
+				remainingSuccessorsCounts[sourceIndex] = 0;
+				upstreamPositions[sourceIndex] = static_cast<int>(upstreamNodesIndexes.size());
+				upstreamNodesIndexes.emplace_back(sourceIndex);
+			}
+			++remainingSuccessorsCounts[sourceIndex];
 		}
 	}
 
-	//Create ullman arrays
-	std::vector<arma::mat > ullmanArrays;
-	ullmanArrays.resize(nodesCombinations.size());
-	auto currentArrayIndex = 0;
-	for (auto& nodesCombination : nodesCombinations)
+	//Preconditions by key, so that those conflicting with a postcondition are found without going through every downstream node.
+	//Only the nodes holding preconditions get a column in the bitsets below, under the position of their preconditions
+	std::unordered_map<uint64_t, std::vector<std::pair<int, const NodeCondition*> > > preNodeConditionsByKey;
+	std::unordered_map<uint64_t, std::vector<std::pair<int, const EdgeCondition*> > > preEdgeConditionsByKey;
+	std::vector<int> preConditionsColumns(nodeCount, NONE);
+	int preConditionsCount = 0;
+	for(const auto nodeIndex : upstreamNodesIndexes)
 	{
-		ullmanArrays[currentArrayIndex] = arma::mat(inSearchedGraph.nodeCount, nodeCount, arma::fill::zeros);
-		for(size_t row = 0; row < nodesCombination.size(); ++row)
+		if(const auto& conditionsBlock = nodes[nodeIndex].conditionsBlock)
 		{
-			ullmanArrays[currentArrayIndex].at(row,nodesCombination[row]) = 1;
+			const auto column = preConditionsCount;
+			for(const auto& nodeCondition : conditionsBlock->preConditions.getNodeConditions())
+			{
+				preNodeConditionsByKey[nodeCondition.getKey()].emplace_back(column, &nodeCondition);
+				preConditionsColumns[nodeIndex] = column;
+			}
+			for(const auto& edgeCondition : conditionsBlock->preConditions.getEdgeConditions())
+			{
+				if(edgeCondition.hasNodes())
+				{
+					preEdgeConditionsByKey[edgeCondition.getKey()].emplace_back(column, &edgeCondition);
+					preConditionsColumns[nodeIndex] = column;
+				}
+			}
+			if(preConditionsColumns[nodeIndex] != NONE)
+			{
+				++preConditionsCount;
+			}
 		}
-		++currentArrayIndex;
 	}
 
-	//Checks for isomorphism
-	std::list<std::list<std::shared_ptr<Node>>> isomorphNodes;
-	for(const auto& ullmanArray : ullmanArrays)
+	//Row of an upstream node holds the preconditions downstream of it, merged at join points by or-ing the rows of its successors
+	BitMatrix downstreamPreConditions(upstreamNodesIndexes.size(), preConditionsCount);
+	std::vector<bool> validSuccessors(nodeCount, true);
+	const auto conflictsWithDownstreamPreConditions = [&preNodeConditionsByKey, &preEdgeConditionsByKey](const Conditions& inPostConditions, const BitMatrix::Word* inDownstreamPreConditions)
 	{
-		bool isSubGraph = true;
-		arma::mat ullmanMatrix = (ullmanArray * (ullmanArray * adjacencyList).t()).t();
-		for(int i = 0; i < inSearchedGraph.nodeCount; ++i)
+		for(const auto& nodeCondition : inPostConditions.getNodeConditions())
 		{
-			for(int j = 0; j < inSearchedGraph.nodeCount; ++j)
+			if(const auto preNodeConditions = preNodeConditionsByKey.find(nodeCondition.getKey()); preNodeConditions != preNodeConditionsByKey.end())
 			{
-				if(static_cast<int>(inSearchedGraph.adjacencyList.at(i,j)) && !static_cast<int>(ullmanMatrix.at(i,j)))
+				for(const auto& [column, preNodeCondition] : preNodeConditions->second)
 				{
-					isSubGraph = false;
-					break;
+					if(BitMatrix::test(inDownstreamPreConditions, column) && preNodeCondition->conflicts(nodeCondition))
+					{
+						return true;
+					}
 				}
 			}
 		}
-
-		if(isSubGraph)
+		for(const auto& edgeCondition : inPostConditions.getEdgeConditions())
 		{
-			std::list<std::shared_ptr<Node> > foundSubNodes; 
-			for(auto row = 0; row < inSearchedGraph.nodeCount; ++row)
+			if(!edgeCondition.hasNodes())
 			{
-				for(auto col = 0; col < nodeCount; ++col)
+				continue;
+			}
+			if(const auto preEdgeConditions = preEdgeConditionsByKey.find(edgeCondition.getKey()); preEdgeConditions != preEdgeConditionsByKey.end())
+			{
+				for(const auto& [column, preEdgeCondition] : preEdgeConditions->second)
 				{
-					if(static_cast<int>(ullmanArray.at(row,col)) == 1)
+					if(BitMatrix::test(inDownstreamPreConditions, column) && preEdgeCondition->conflicts(edgeCondition))
 					{
-						foundSubNodes.emplace_back(nodesByIndex.at(col));
+						return true;
 					}
 				}
 			}
-			isomorphNodes.push_back(foundSubNodes);
 		}
-	}
+		return false;
+	};
 
-	//Ensure returned combinations are correct (due to the cartisian product done earlier, some of them don't answer the direction and label of edges
-	for(auto& subNodes : isomorphNodes)
+	std::vector<int> readyNodesIndexes{inNodeIndex};
+	while(!readyNodesIndexes.empty())
 	{
-		//First we check all nodes two by two
-		bool isCorrect = true;
-		auto subNode = subNodes.begin();
-		for(auto i = 0; i < static_cast<int>(subNodes.size()) - 1; ++i)
+		const auto nodeIndex = readyNodesIndexes.back();
+		readyNodesIndexes.pop_back();
+		auto& node = nodes[nodeIndex];
+		PRINTLN("Validating conditions for: " + node.getName());
+		const auto bWasValid = node.bIsValid;
+		node.bIsValid = validSuccessors[nodeIndex] && node.bIsValid;
+
+		const auto* nodeDownstreamPreConditions = downstreamPreConditions.getRow(upstreamPositions[nodeIndex]);
+		if(node.conditionsBlock && conflictsWithDownstreamPreConditions(node.conditionsBlock->postConditions, nodeDownstreamPreConditions))
+		{
+			PRINTLN("Invalid");
+#ifndef NDEBUG
+			node.conditionsBlock->postConditions.print();
+#endif
+			node.bIsValid = false;
+		}
+		if(bIsInTransaction && node.bIsValid != bWasValid)
 		{
-			auto previousNode = subNode;
-			++subNode;
+			auto& undoRecord = undoLog.emplace_back(GraphUndoRecord::Type::SetNodeValidity, nodeIndex);
+			undoRecord.bWasValid = bWasValid;
+		}
 
-			const auto nextIndex = i + 1;
-			
-			if(static_cast<int>(inSearchedGraph.adjacencyList.at(i, nextIndex)))
+		for(const auto incomingEdge : node.incomingEdges)
+		{
+			const auto sourceIndex = edges[incomingEdge].sourceIndex;
+			auto* sourceDownstreamPreConditions = downstreamPreConditions.getRow(upstreamPositions[sourceIndex]);
+			BitMatrix::orRows(sourceDownstreamPreConditions, nodeDownstreamPreConditions, downstreamPreConditions.getWordsPerRow());
+			if(preConditionsColumns[nodeIndex] != NONE)
+			{
+				BitMatrix::set(sourceDownstreamPreConditions, preConditionsColumns[nodeIndex]);
+			}
+			validSuccessors[sourceIndex] = validSuccessors[sourceIndex] && node.bIsValid;
+			if(--remainingSuccessorsCounts[sourceIndex] == 0)
+			{
+				readyNodesIndexes.emplace_back(sourceIndex);
+			}
+		}
+	}
+}
+
+void Graph::beginTransaction()
+{
+	assert(!bIsInTransaction);
+	bIsInTransaction = true;
+	transactionOperationCount = operations.size();
+	transactionNodeCount = nodeCount;
+	transactionEdgeHandleCount = edges.getHandleCount();
+}
+
+void Graph::commitTransaction()
+{
+	assert(bIsInTransaction);
+	bIsInTransaction = false;
+	undoLog.clear();
+}
+
+void Graph::rollbackTransaction()
+{
+	assert(bIsInTransaction);
+	bIsInTransaction = false;
+
+	//Each record is reverted on the state its modification left, nothing is journaled or recorded again
+	for(auto undoRecord = undoLog.rbegin(); undoRecord != undoLog.rend(); ++undoRecord)
+	{
+		switch(undoRecord->type)
+		{
+			case GraphUndoRecord::Type::AddNode:
 			{
-				if(auto edge = inSearchedGraph.edgesByNodesIndex.at({i, nextIndex}); !Node::containsEdges({edgesByNodesIndex.at({previousNode->get()->index, subNode->get()->index})}, {edge}))
+				const auto& addedNode = nodes[undoRecord->sourceIndex];
+				assert(addedNode.incomingEdges.empty() && addedNode.outgoingEdges.empty());
+				nodesByName.erase(addedNode.name);
+				for(const auto& [attributeName, attributeData] : addedNode.attributes)
 				{
-					isCorrect = false;
-					break;
+					unindexNodeAttribute(undoRecord->sourceIndex, attributeName, attributeData.getText());
 				}
+				nodes.destroy(undoRecord->sourceIndex);
+				break;
 			}
-
-			if(static_cast<int>(inSearchedGraph.adjacencyList.at(nextIndex, i)))
+			case GraphUndoRecord::Type::RemoveNode:
 			{
-				if(auto edge = inSearchedGraph.edgesByNodesIndex.at({nextIndex, i}); !Node::containsEdges({edgesByNodesIndex.at({subNode->get()->index, previousNode->get()->index})}, {edge}))
+				nodes.restore(undoRecord->sourceIndex, std::move(undoRecord->removedNode));
+				const auto& restoredNode = nodes[undoRecord->sourceIndex];
+				nodesByName[restoredNode.name] = undoRecord->sourceIndex;
+				for(const auto& [attributeName, attributeData] : restoredNode.attributes)
 				{
-					isCorrect = false;
-					break;
+					indexNodeAttribute(undoRecord->sourceIndex, attributeName, attributeData.getText());
 				}
+				break;
 			}
-		}
-
-		//Then we check the first one with the last one
-		if(isCorrect && inSearchedGraph.nodeCount > 1)
-		{
-			const auto lastNode = --subNodes.end();
-			const auto beforeLastNode  = --(--subNodes.end());
-			const int lastIndex = static_cast<int>(subNodes.size() - 1);
-			const int beforeLastIndex = static_cast<int>(subNodes.size() - 2);
-			
-			if(static_cast<int>(inSearchedGraph.adjacencyList.at(beforeLastIndex, lastIndex)))
+			case GraphUndoRecord::Type::SetNodeAttribute:
 			{
-				if(!Node::containsEdges({edgesByNodesIndex.at({beforeLastNode->get()->index, lastNode->get()->index})}, {inSearchedGraph.edgesByNodesIndex.at({beforeLastIndex, lastIndex})}))
+				auto& node = nodes[undoRecord->sourceIndex];
+				unindexNodeAttribute(undoRecord->sourceIndex, undoRecord->attributeName, node.attributes.at(undoRecord->attributeName).getText());
+				if(undoRecord->previousAttribute)
 				{
-					isCorrect = false;
+					node.attributes[undoRecord->attributeName] = *undoRecord->previousAttribute;
+					indexNodeAttribute(undoRecord->sourceIndex, undoRecord->attributeName, undoRecord->previousAttribute->getText());
 				}
+				else
+				{
+					node.attributes.erase(undoRecord->attributeName);
+				}
+				break;
 			}
-
-			if(isCorrect)
+			case GraphUndoRecord::Type::SetNodeValidity:
+			{
+				nodes[undoRecord->sourceIndex].bIsValid = undoRecord->bWasValid;
+				break;
+			}
+			case GraphUndoRecord::Type::AddEdge:
 			{
-				if(static_cast<int>(inSearchedGraph.adjacencyList.at( lastIndex, beforeLastIndex)))
+				if(undoRecord->bInsertedEdgeAttribute)
 				{
-					if(!Node::containsEdges({edgesByNodesIndex.at({ lastNode->get()->index, beforeLastNode->get()->index})}, {inSearchedGraph.edgesByNodesIndex.at({lastIndex, beforeLastIndex})}))
-					{
-						isCorrect = false;
-					}
+					edges[undoRecord->edgeHandle].attributes.erase(undoRecord->attributeName);
+				}
+				if(undoRecord->bCreatedEdge)
+				{
+					auto& sourceNode = nodes[undoRecord->sourceIndex];
+					auto& targetNode = nodes[undoRecord->targetIndex];
+					assert(sourceNode.outgoingEdges.back() == undoRecord->edgeHandle && targetNode.incomingEdges.back() == undoRecord->edgeHandle);
+					sourceNode.outgoingEdges.pop_back();
+					targetNode.incomingEdges.pop_back();
+					edgesByNodesIndex.erase({undoRecord->sourceIndex, undoRecord->targetIndex});
+					edgesByNodesNames.erase({sourceNode.name, targetNode.name});
+					adjacencyList.reset(undoRecord->sourceIndex, undoRecord->targetIndex);
+					incomingAdjacencyList.reset(undoRecord->targetIndex, undoRecord->sourceIndex);
+					edges.destroy(undoRecord->edgeHandle);
 				}
+				break;
+			}
+			case GraphUndoRecord::Type::RemoveEdge:
+			{
+				auto& sourceNode = nodes[undoRecord->sourceIndex];
+				auto& targetNode = nodes[undoRecord->targetIndex];
+				edges.restore(undoRecord->edgeHandle, std::move(undoRecord->removedEdge));
+				sourceNode.outgoingEdges.insert(sourceNode.outgoingEdges.begin() + static_cast<std::ptrdiff_t>(undoRecord->outgoingEdgePosition), undoRecord->edgeHandle);
+				targetNode.incomingEdges.insert(targetNode.incomingEdges.begin() + static_cast<std::ptrdiff_t>(undoRecord->incomingEdgePosition), undoRecord->edgeHandle);
+				edgesByNodesIndex[{undoRecord->sourceIndex, undoRecord->targetIndex}] = undoRecord->edgeHandle;
+				edgesByNodesNames[{sourceNode.name, targetNode.name}] = undoRecord->edgeHandle;
+				adjacencyList.set(undoRecord->sourceIndex, undoRecord->targetIndex);
+				incomingAdjacencyList.set(undoRecord->targetIndex, undoRecord->sourceIndex);
+				break;
 			}
-		}
-		if(isCorrect)
-		{
-			outFoundSubNodes.emplace_back(subNodes);
 		}
 	}
-}
\ No newline at end of file
+	undoLog.clear();
+
+	//Handles first given during the transaction are all free again
+	nodes.shrink(transactionNodeCount);
+	edges.shrink(transactionEdgeHandleCount);
+	nodeCount = transactionNodeCount;
+	operations.resize(transactionOperationCount);
+	++version; //The state is the one before the transaction, but results tied to intermediate versions must not be taken for current ones
+}
+
+bool Graph::isInTransaction() const
+{
+	return bIsInTransaction;
+}
@@ -0,0 +1,200 @@
+#include "GraphSnapshot.h"
+
+#include <algorithm>
+
+GraphSnapshot::GraphSnapshot(const Graph& inGraph) : version(inGraph.getVersion()), nodeCount(inGraph.getNodeCount()), nodesNames(nodeCount)
+{
+	std::unordered_map<int, int> edgesIndexes; //By edge handle in the graph
+	edgesIndexes.reserve(inGraph.getEdgesByNodesIndex().size());
+	edgesAttributesOffsets.emplace_back(0);
+	for(const auto& [nodesIndexes, edgeHandle] : inGraph.getEdgesByNodesIndex())
+	{
+		const auto& edgeAttributes = inGraph.getEdge(edgeHandle).getAttributes();
+		edgesIndexes.emplace(edgeHandle, static_cast<int>(edgesSources.size()));
+		edgesSources.emplace_back(nodesIndexes.first);
+		edgesTargets.emplace_back(nodesIndexes.second);
+		edgesAttributes.insert(edgesAttributes.end(), edgeAttributes.begin(), edgeAttributes.end());
+		edgesAttributesOffsets.emplace_back(static_cast<int>(edgesAttributes.size()));
+	}
+
+	outgoingOffsets.reserve(nodeCount + 1);
+	incomingOffsets.reserve(nodeCount + 1);
+	outgoingOffsets.emplace_back(0);
+	incomingOffsets.emplace_back(0);
+	for(int nodeIndex = 0; nodeIndex < nodeCount; ++nodeIndex)
+	{
+		if(const auto* node = inGraph.getNodeByIndex(nodeIndex))
+		{
+			nodesNames[nodeIndex] = node->getNameSymbol();
+			for(const auto& [attributeName, attributeData] : node->getAttributes())
+			{
+				auto& attributeColumn = attributesColumns[attributeName];
+				attributeColumn.resize(nodeCount);
+				attributeColumn[nodeIndex] = attributeData.getText();
+			}
+
+			for(const auto edgeHandle : node->getOutgoingEdges())
+			{
+				const auto edgeIndex = edgesIndexes.at(edgeHandle);
+				outgoingEdges.emplace_back(edgeIndex);
+				outgoingNeighbours.emplace_back(edgesTargets[edgeIndex]);
+			}
+			for(const auto edgeHandle : node->getIncomingEdges())
+			{
+				const auto edgeIndex = edgesIndexes.at(edgeHandle);
+				incomingEdges.emplace_back(edgeIndex);
+				incomingNeighbours.emplace_back(edgesSources[edgeIndex]);
+			}
+		}
+		outgoingOffsets.emplace_back(static_cast<int>(outgoingEdges.size()));
+		incomingOffsets.emplace_back(static_cast<int>(incomingEdges.size()));
+	}
+}
+
+int GraphSnapshot::getVersion() const
+{
+	return version;
+}
+
+int GraphSnapshot::getNodeCount() const
+{
+	return nodeCount;
+}
+
+bool GraphSnapshot::hasNode(const int inNodeIndex) const
+{
+	return nodesNames[inNodeIndex] != Symbol();
+}
+
+Symbol GraphSnapshot::getNodeName(const int inNodeIndex) const
+{
+	return nodesNames[inNodeIndex];
+}
+
+Symbol GraphSnapshot::getNodeAttribute(const int inNodeIndex, const Symbol inAttributeName) const
+{
+	const auto attributeColumn = attributesColumns.find(inAttributeName);
+	return attributeColumn != attributesColumns.end() ? attributeColumn->second[inNodeIndex] : Symbol();
+}
+
+std::span<const int> GraphSnapshot::getOutgoingEdges(const int inNodeIndex) const
+{
+	return {outgoingEdges.data() + outgoingOffsets[inNodeIndex], outgoingEdges.data() + outgoingOffsets[inNodeIndex + 1]};
+}
+
+std::span<const int> GraphSnapshot::getIncomingEdges(const int inNodeIndex) const
+{
+	return {incomingEdges.data() + incomingOffsets[inNodeIndex], incomingEdges.data() + incomingOffsets[inNodeIndex + 1]};
+}
+
+std::span<const int> GraphSnapshot::getOutgoingNeighbours(const int inNodeIndex) const
+{
+	return {outgoingNeighbours.data() + outgoingOffsets[inNodeIndex], outgoingNeighbours.data() + outgoingOffsets[inNodeIndex + 1]};
+}
+
+std::span<const int> GraphSnapshot::getIncomingNeighbours(const int inNodeIndex) const
+{
+	return {incomingNeighbours.data() + incomingOffsets[inNodeIndex], incomingNeighbours.data() + incomingOffsets[inNodeIndex + 1]};
+}
+
+int GraphSnapshot::getEdgeSource(const int inEdgeIndex) const
+{
+	return edgesSources[inEdgeIndex];
+}
+
+int GraphSnapshot::getEdgeTarget(const int inEdgeIndex) const
+{
+	return edgesTargets[inEdgeIndex];
+}
+
+std::span<const std::pair<Symbol, Symbol>> GraphSnapshot::getEdgeAttributes(const int inEdgeIndex) const
+{
+	return {edgesAttributes.data() + edgesAttributesOffsets[inEdgeIndex], edgesAttributes.data() + edgesAttributesOffsets[inEdgeIndex + 1]};
+}
+
+const std::pair<Symbol, Symbol>* GraphSnapshot::findEdgeAttribute(const int inEdgeIndex, const Symbol inAttributeName) const
+{
+	const auto attributes = getEdgeAttributes(inEdgeIndex);
+	const auto attribute = std::ranges::find(attributes, inAttributeName, &std::pair<Symbol, Symbol>::first);
+	return attribute != attributes.end() ? &*attribute : nullptr;
+}
+
+int GraphSnapshot::findEdge(const int inSourceIndex, const int inTargetIndex) const
+{
+	const auto targets = getOutgoingNeighbours(inSourceIndex);
+	const auto target = std::ranges::find(targets, inTargetIndex);
+	return target != targets.end() ? getOutgoingEdges(inSourceIndex)[target - targets.begin()] : NONE;
+}
+
+int GraphSnapshot::findSourceNodeFromIncomingEdgeWithAttribute(const int inNodeIndex, const std::pair<Symbol, Symbol>& inAttribute) const
+{
+	for(const auto edgeIndex : getIncomingEdges(inNodeIndex))
+	{
+		if(const auto* attribute = findEdgeAttribute(edgeIndex, inAttribute.first); attribute && (inAttribute.second == Symbols::NOT_AVAILABLE || attribute->second == inAttribute.second))
+		{
+			return edgesSources[edgeIndex];
+		}
+	}
+	return NONE;
+}
+
+int GraphSnapshot::findTargetNodeFromOutgoingEdgeWithAttribute(const int inNodeIndex, const std::pair<Symbol, Symbol>& inAttribute) const
+{
+	for(const auto edgeIndex : getOutgoingEdges(inNodeIndex))
+	{
+		if(const auto* attribute = findEdgeAttribute(edgeIndex, inAttribute.first); attribute && (inAttribute.second == Symbols::NOT_AVAILABLE || attribute->second == inAttribute.second))
+		{
+			return edgesTargets[edgeIndex];
+		}
+	}
+	return NONE;
+}
+
+bool GraphSnapshot::containsEdges(const std::span<const int> inEdgesIndexes, const Graph& inParentGraph, const std::vector<int>& inParentEdges) const
+{
+	//Each parent edge takes the first edge not already taken that holds one of its attributes
+	uint64_t takenEdgesMask = 0;
+	std::vector<bool> takenEdges(inEdgesIndexes.size() > 64 ? inEdgesIndexes.size() : 0); //Only allocated for nodes with more than 64 edges
+	const auto isTaken = [&](const size_t inPosition){ return takenEdges.empty() ? (takenEdgesMask >> inPosition) & 1 : takenEdges[inPosition]; };
+	const auto take = [&](const size_t inPosition)
+	{
+		if(takenEdges.empty())
+		{
+			takenEdgesMask |= uint64_t{1} << inPosition;
+		}
+		else
+		{
+			takenEdges[inPosition] = true;
+		}
+	};
+
+	for(const auto parentEdge : inParentEdges)
+	{
+		bool containsEdge = false;
+		for(size_t position = 0; position < inEdgesIndexes.size() && !containsEdge; ++position)
+		{
+			if(!isTaken(position) && containsEdgeAttribute(inEdgesIndexes[position], inParentGraph.getEdge(parentEdge)))
+			{
+				take(position);
+				containsEdge = true;
+			}
+		}
+		if(!containsEdge)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+bool GraphSnapshot::containsEdgeAttribute(const int inEdgeIndex, const Edge& inParentEdge) const
+{
+	const auto attributes = getEdgeAttributes(inEdgeIndex);
+	return std::ranges::any_of(inParentEdge.getAttributes(), [&attributes](const std::pair<Symbol, Symbol>& inParentAttribute)
+	{
+		return std::ranges::any_of(attributes, [&inParentAttribute](const std::pair<Symbol, Symbol>& inAttribute)
+		{
+			return inAttribute.first == inParentAttribute.first && (inParentAttribute.second == Symbols::NOT_AVAILABLE || inParentAttribute.second == inAttribute.second);
+		});
+	});
+}
@@ -0,0 +1,112 @@
+#include "IncrementalMatcher.h"
+
+#include <algorithm>
+
+#include "SubGraphMatcher.h"
+#include "ThreadPool.h"
+
+IncrementalMatcher::IncrementalMatcher(const Graph& inGraph, const std::list<const Graph*>& inSearchedGraphs) : operationCount(0)
+{
+	for(const auto* searchedGraph : inSearchedGraphs)
+	{
+		mappings[searchedGraph];
+	}
+	search(inGraph);
+}
+
+void IncrementalMatcher::update(const Graph& inGraph)
+{
+	const auto& operations = inGraph.getOperations();
+	if(operationCount > operations.size()) //The journal doesn't extend the one the mappings were found from anymore
+	{
+		search(inGraph);
+		return;
+	}
+
+	//A mapping can only appear or disappear if it involves a node whose existence, attributes or edges were modified
+	std::vector<int> modifiedNodesIndexes;
+	for(auto operation = operations.begin() + static_cast<std::ptrdiff_t>(operationCount); operation != operations.end(); ++operation)
+	{
+		modifiedNodesIndexes.emplace_back(operation->sourceIndex);
+		if(operation->targetIndex != NONE)
+		{
+			modifiedNodesIndexes.emplace_back(operation->targetIndex);
+		}
+	}
+	operationCount = operations.size();
+	if(modifiedNodesIndexes.empty())
+	{
+		return;
+	}
+	std::ranges::sort(modifiedNodesIndexes);
+	modifiedNodesIndexes.erase(std::ranges::unique(modifiedNodesIndexes).begin(), modifiedNodesIndexes.end());
+
+	forEachSearchedGraph([&inGraph, &modifiedNodesIndexes](const Graph& inSearchedGraph, std::vector<std::vector<int> >& ioMappings)
+	{
+		std::erase_if(ioMappings, [&modifiedNodesIndexes](const std::vector<int>& inMapping)
+		{
+			return std::ranges::any_of(inMapping, [&modifiedNodesIndexes](const int inNodeIndex){ return std::ranges::binary_search(modifiedNodesIndexes, inNodeIndex); });
+		});
+
+		std::vector<std::vector<int> > foundMappings;
+		for(const auto nodeIndex : modifiedNodesIndexes)
+		{
+			if(!inGraph.getNodeByIndex(nodeIndex))
+			{
+				continue;
+			}
+			for(int searchedNodeIndex = 0; searchedNodeIndex < inSearchedGraph.getNodeCount(); ++searchedNodeIndex)
+			{
+				SubGraphMatcher matcher(inGraph, inSearchedGraph, searchedNodeIndex, nodeIndex);
+				while(matcher.next())
+				{
+					foundMappings.emplace_back(matcher.getMapping());
+				}
+			}
+		}
+
+		//Mappings involving several modified nodes are found once per node, a single copy is kept. The kept ones don't involve modified nodes, so none of them is found again
+		std::ranges::sort(foundMappings);
+		foundMappings.erase(std::ranges::unique(foundMappings).begin(), foundMappings.end());
+		const auto keptMappingsCount = static_cast<std::ptrdiff_t>(ioMappings.size());
+		ioMappings.insert(ioMappings.end(), std::make_move_iterator(foundMappings.begin()), std::make_move_iterator(foundMappings.end()));
+		std::inplace_merge(ioMappings.begin(), ioMappings.begin() + keptMappingsCount, ioMappings.end());
+	});
+}
+
+const std::vector<std::vector<int> >& IncrementalMatcher::getMappings(const Graph& inSearchedGraph) const
+{
+	return mappings.at(&inSearchedGraph);
+}
+
+void IncrementalMatcher::search(const Graph& inGraph)
+{
+	operationCount = inGraph.getOperations().size();
+	forEachSearchedGraph([&inGraph](const Graph& inSearchedGraph, std::vector<std::vector<int> >& ioMappings)
+	{
+		ioMappings.clear();
+		SubGraphMatcher matcher(inGraph, inSearchedGraph);
+		while(matcher.next())
+		{
+			ioMappings.emplace_back(matcher.getMapping());
+		}
+		std::ranges::sort(ioMappings);
+	});
+}
+
+void IncrementalMatcher::forEachSearchedGraph(const std::function<void(const Graph&, std::vector<std::vector<int> >&)>& inFunction)
+{
+	//Each task only touches the mappings of its own searched graph
+	auto* threadPool = ThreadPool::getInstance();
+	const auto searches = threadPool->createTaskGroup();
+	std::vector<std::future<void> > tasks;
+	tasks.reserve(mappings.size());
+	for(auto& searchedGraphMappings : mappings)
+	{
+		tasks.emplace_back(threadPool->submit(searches, [&inFunction, &searchedGraphMappings](){ inFunction(*searchedGraphMappings.first, searchedGraphMappings.second); }));
+	}
+	for(auto& task : tasks)
+	{
+		threadPool->wait(searches, task);
+	}
+}
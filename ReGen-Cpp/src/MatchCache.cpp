@@ -0,0 +1,158 @@
+#include "MatchCache.h"
+
+#include <filesystem>
+#include <fstream>
+
+#include "SubGraphMatcher.h"
+
+const std::vector<std::vector<int>>& MatchCache::getMappings(const Graph& inGraph, const Graph& inSearchedGraph)
+{
+	std::promise<std::vector<std::vector<int> > > mappingsPromise;
+	std::shared_future<std::vector<std::vector<int> > > mappings;
+	{
+		std::lock_guard lock(entriesMutex);
+		auto& entry = entries[{&inGraph, &inSearchedGraph}];
+		if(entry.mappings.valid() && entry.graphVersion == inGraph.getVersion() && entry.searchedGraphVersion == inSearchedGraph.getVersion())
+		{
+			mappings = entry.mappings;
+		}
+		else //First one to ask computes the mappings, others wait for them
+		{
+			entry = {inGraph.getVersion(), inSearchedGraph.getVersion(), mappingsPromise.get_future().share()};
+		}
+	}
+
+	if(mappings.valid())
+	{
+		return mappings.get();
+	}
+
+	std::vector<std::vector<int> > foundMappings;
+	SubGraphMatcher matcher(inGraph, inSearchedGraph);
+	while(matcher.next())
+	{
+		foundMappings.emplace_back(matcher.getMapping());
+	}
+	mappingsPromise.set_value(std::move(foundMappings));
+
+	std::lock_guard lock(entriesMutex);
+	return entries.at({&inGraph, &inSearchedGraph}).mappings.get();
+}
+
+void MatchCache::load(const std::string& inPath, const Graph& inGraph, const std::list<const Graph*>& inSearchedGraphs)
+{
+	std::ifstream file(inPath);
+	if(!file)
+	{
+		return;
+	}
+
+	const auto graphHash = inGraph.computeContentHash();
+	std::unordered_map<uint64_t, const Graph*> searchedGraphsByHash;
+	for(const auto* searchedGraph : inSearchedGraphs)
+	{
+		searchedGraphsByHash[searchedGraph->computeContentHash()] = searchedGraph;
+	}
+
+	//Each entry is a header "graphHash searchedGraphHash mappingCount mappingSize" followed by one mapping per line
+	//Every mapping takes at least one character per node index and separator, larger counts can only come from a corrupt file
+	const auto fileSize = std::filesystem::file_size(inPath);
+	uint64_t entryGraphHash;
+	uint64_t entrySearchedGraphHash;
+	size_t mappingCount;
+	size_t mappingSize;
+	std::lock_guard lock(entriesMutex);
+	while(file >> entryGraphHash >> entrySearchedGraphHash >> mappingCount >> mappingSize)
+	{
+		if(mappingSize > fileSize || mappingCount > fileSize / std::max<size_t>(mappingSize * 2, 1))
+		{
+			return; //The next entries can't be found anymore
+		}
+
+		//Entries of other graphs are read through to reach the next ones, mappings are only kept if each of their indexes names a live node of the graph
+		const auto searchedGraph = searchedGraphsByHash.find(entrySearchedGraphHash);
+		auto bIsEntryValid = entryGraphHash == graphHash && searchedGraph != searchedGraphsByHash.end() && mappingSize == static_cast<size_t>(searchedGraph->second->getNodeCount());
+		std::vector<std::vector<int> > mappings;
+		if(bIsEntryValid)
+		{
+			mappings.reserve(mappingCount);
+		}
+		for(size_t mappingIndex = 0; mappingIndex < mappingCount; ++mappingIndex)
+		{
+			std::vector<int> mapping(bIsEntryValid ? mappingSize : 0);
+			for(size_t searchedNodeIndex = 0; searchedNodeIndex < mappingSize; ++searchedNodeIndex)
+			{
+				int nodeIndex;
+				file >> nodeIndex;
+				if(bIsEntryValid)
+				{
+					bIsEntryValid = inGraph.getNodeByIndex(nodeIndex) != nullptr;
+					mapping[searchedNodeIndex] = nodeIndex;
+				}
+			}
+			if(bIsEntryValid)
+			{
+				mappings.emplace_back(std::move(mapping));
+			}
+		}
+		if(!file)
+		{
+			return;
+		}
+
+		if(bIsEntryValid)
+		{
+			std::promise<std::vector<std::vector<int> > > mappingsPromise;
+			mappingsPromise.set_value(std::move(mappings));
+			entries[{&inGraph, searchedGraph->second}] = {inGraph.getVersion(), searchedGraph->second->getVersion(), mappingsPromise.get_future().share()};
+		}
+	}
+}
+
+void MatchCache::forget(const Graph& inGraph)
+{
+	std::lock_guard lock(entriesMutex);
+	std::erase_if(entries, [&inGraph](const auto& inEntry)
+	{
+		return inEntry.first.first == &inGraph || inEntry.first.second == &inGraph;
+	});
+}
+
+void MatchCache::save(const std::string& inPath) const
+{
+	if(const auto directory = std::filesystem::path(inPath).parent_path(); !directory.empty() && !std::filesystem::exists(directory))
+	{
+		std::filesystem::create_directories(directory);
+	}
+
+	std::ofstream file(inPath, std::ios::out | std::ios::trunc);
+	assert(file);
+
+	std::unordered_map<const Graph*, uint64_t> hashesByGraph;
+	const auto getHash = [&hashesByGraph](const Graph* inGraph)
+	{
+		if(const auto hash = hashesByGraph.find(inGraph); hash != hashesByGraph.end())
+		{
+			return hash->second;
+		}
+		return hashesByGraph[inGraph] = inGraph->computeContentHash();
+	};
+
+	std::lock_guard lock(entriesMutex);
+	for(const auto& [graphs, entry] : entries)
+	{
+		if(entry.graphVersion == graphs.first->getVersion() && entry.searchedGraphVersion == graphs.second->getVersion()) //Outdated entries would be searched again anyway
+		{
+			const auto& mappings = entry.mappings.get();
+			file << getHash(graphs.first) << " " << getHash(graphs.second) << " " << mappings.size() << " " << graphs.second->getNodeCount() << std::endl;
+			for(const auto& mapping : mappings)
+			{
+				for(const auto nodeIndex : mapping)
+				{
+					file << nodeIndex << " ";
+				}
+				file << std::endl;
+			}
+		}
+	}
+}
@@ -0,0 +1,87 @@
+#include "OutputPipeline.h"
+
+OutputPipeline::OutputPipeline() : unfinishedOutputCount(0), bRenderImages(true)
+{
+	//Rendering mostly waits on dot processes, half the cores leave the others to the generation
+	const auto workerCount = std::max(std::thread::hardware_concurrency() / 2, 1u);
+	workers.reserve(workerCount);
+	for(unsigned i = 0; i < workerCount; ++i)
+	{
+		workers.emplace_back(&OutputPipeline::work, this);
+		workers.back().detach(); //The pipeline lives as long as the process
+	}
+}
+
+void OutputPipeline::save(Graph&& inGraph, std::string inColor, std::string inFontColor, std::string inOutputPath)
+{
+	auto graph = std::make_shared<const Graph>(std::move(inGraph)); //Shared as the queued function must be copyable, the graph is freed once written
+	push([this, graph, color = std::move(inColor), fontColor = std::move(inFontColor), outputPath = std::move(inOutputPath)]()
+	{
+		renderImage(graph->saveAsDotFile(color, fontColor, outputPath));
+	});
+}
+
+void OutputPipeline::render(std::string inDotFilePath)
+{
+	push([this, dotFilePath = std::move(inDotFilePath)](){ renderImage(dotFilePath); });
+}
+
+void OutputPipeline::setRenderImages(const bool bInRenderImages)
+{
+	bRenderImages = bInRenderImages;
+}
+
+void OutputPipeline::flush()
+{
+	std::unique_lock lock(outputsMutex);
+	finishedCondition.wait(lock, [this](){ return unfinishedOutputCount == 0; });
+}
+
+void OutputPipeline::push(std::function<void()>&& inOutput)
+{
+	{
+		std::unique_lock lock(outputsMutex);
+		spaceCondition.wait(lock, [this](){ return outputs.size() < MAX_PENDING_OUTPUTS; });
+		outputs.emplace_back(std::move(inOutput));
+		++unfinishedOutputCount;
+	}
+	outputsCondition.notify_one();
+}
+
+void OutputPipeline::work()
+{
+	while(true)
+	{
+		std::function<void()> output;
+		{
+			std::unique_lock lock(outputsMutex);
+			outputsCondition.wait(lock, [this](){ return !outputs.empty(); });
+			output = std::move(outputs.front());
+			outputs.pop_front();
+		}
+		spaceCondition.notify_one();
+		output();
+		output = nullptr; //Frees the graph before the output is reported as finished
+
+		bool bIsIdle;
+		{
+			std::lock_guard lock(outputsMutex);
+			bIsIdle = --unfinishedOutputCount == 0;
+		}
+		if(bIsIdle)
+		{
+			finishedCondition.notify_all();
+		}
+	}
+}
+
+void OutputPipeline::renderImage(const std::string& inDotFilePath) const
+{
+	if(!bRenderImages)
+	{
+		return;
+	}
+	assert(inDotFilePath.ends_with(".dot"));
+	const auto imageFilePath = inDotFilePath.substr(0, inDotFilePath.size() - 4) + ".png";
+	system(("dot -Tpng " + inDotFilePath + " -o " + imageFilePath).c_str());
+}
@@ -1,101 +1,136 @@
 #include "Scheduler.h"
 
+#include <cmath>
+
 #include "CommandsRegistry.h"
 #include "DataManager.h"
+#include "IncrementalMatcher.h"
+#include "MatchCache.h"
+#include "OutputPipeline.h"
 #include "Rule.h"
 #include "Conditions.h"
+#include "ThreadPool.h"
+#include "WeightedSampler.h"
 
-std::default_random_engine Scheduler::randomEngine(static_cast<unsigned>(std::chrono::high_resolution_clock::now().time_since_epoch().count()));
-std::unordered_map<std::string, int> Scheduler::rulesUsages;  // NOLINT(clang-diagnostic-exit-time-destructors)
+Scheduler::Scheduler(std::string inQuestName, const uint64_t inSeed) : initializationRule(nullptr), questName(std::move(inQuestName))
+{
+	std::seed_seq seedSequence{static_cast<uint32_t>(inSeed), static_cast<uint32_t>(inSeed >> 32)};
+	randomEngine.seed(seedSequence);
+}
 
-Scheduler::Scheduler(std::string inQuestName) : questName(std::move(inQuestName))
+void Scheduler::runBatch(const std::string& inQuestNamePrefix, const int inStoryCount, const uint64_t inMasterSeed)
 {
-	if(rulesUsages.empty())
+	PRINTLN("Generating " + std::to_string(inStoryCount) + " stories from the master seed " + std::to_string(inMasterSeed));
+	std::unordered_map<std::string, int> initializationRulesUsages;
+	for(const auto& [name, socialConditions, storyConditions, storyGraph, nodesModifications, socialNodesRolesSlots, storyNodesTargetsSlots, appliesOnce] : DataManager::getInstance()->getInitializationRules())
 	{
-		for(const auto& [name, socialConditions, storyConditions, storyGraph, nodeModificationArguments, appliesOnce] : DataManager::getInstance()->getInitializationRules())
-		{
-			rulesUsages[name] = 0;
-		}
+		initializationRulesUsages[name] = 0;
+	}
+
+	//Initialization rules applying once are applied by a single story of the batch. They are picked in story order, so that which story gets them doesn't depend on scheduling
+	std::vector<Scheduler> schedulers;
+	schedulers.reserve(inStoryCount);
+	for(int storyIndex = 0; storyIndex < inStoryCount; ++storyIndex)
+	{
+		schedulers.emplace_back(inQuestNamePrefix + std::to_string(storyIndex), getStorySeed(inMasterSeed, storyIndex)).pickInitializationRule(initializationRulesUsages);
+	}
+
+	//From then on, stories only share read-only data
+	auto* threadPool = ThreadPool::getInstance();
+	const auto storiesGeneration = threadPool->createTaskGroup();
+	std::vector<std::future<void> > stories;
+	stories.reserve(schedulers.size());
+	for(auto& scheduler : schedulers)
+	{
+		stories.emplace_back(threadPool->submit(storiesGeneration, [&scheduler](){ scheduler.run(); }));
+	}
+	for(auto& story : stories)
+	{
+		threadPool->wait(storiesGeneration, story);
 	}
 }
 
-void Scheduler::run()
+uint64_t Scheduler::getStorySeed(const uint64_t inMasterSeed, const int inStoryIndex)
 {
-	PRINTLN("Creating initial narrative");
-	PRINT_SEPARATOR();
+	//SplitMix64, so that consecutive story indexes give unrelated seeds
+	auto seed = inMasterSeed + (static_cast<uint64_t>(inStoryIndex) + 1) * 0x9E3779B97F4A7C15ull;
+	seed = (seed ^ seed >> 30) * 0xBF58476D1CE4E5B9ull;
+	seed = (seed ^ seed >> 27) * 0x94D049BB133111EBull;
+	return seed ^ seed >> 31;
+}
 
-	Graph resultStory(questName, "Story_Graph");
-	resultStory.addNode(new Node("Start_Quest", {{"Node_Type", {"str", "Start"}}}));
-	resultStory.addNode(new Node("End_Quest", {{"Node_Type", {"str", "End"}}}));
-	
+void Scheduler::pickInitializationRule(std::unordered_map<std::string, int>& ioRulesUsages)
+{
 	PRINTLN("Searching for Possible Narrative Rules...");
-	std::unordered_map<Rule, std::list<std::list<std::shared_ptr<Node> > >, RuleHashFunction> possibleRules;
-	getPossibleRules(DataManager::getInstance()->getInitializationRules(), DataManager::getInstance()->getWorldGraph(), rulesUsages, possibleRules);
+	std::vector<const Rule*> possibleRules;
+	const auto& worldGraph = DataManager::getInstance()->getWorldGraph();
+	getPossibleRules(DataManager::getInstance()->getInitializationRules(), ioRulesUsages, [&worldGraph](const Rule& inRule)
+	{
+		return !MatchCache::getInstance()->getMappings(worldGraph, inRule.socialConditions).empty(); //The world graph doesn't change between stories, its mappings are cached
+	}, possibleRules);
 	PRINTLN(std::string("Found ") + std::to_string(possibleRules.size()) + " possible rules.");
 	if(possibleRules.empty())
 	{
-		PRINTLN("No possible rules found. Generation failed.");
-		return; //TODO proper failure handling
+		return;
 	}
-	
-	std::uniform_int_distribution randomIntDistribution{0, static_cast<int>(possibleRules.size()) - 1};
-	int targetIndex = randomIntDistribution(randomEngine);
-	int count = 0;
-	std::pair<Rule, std::list<std::list<std::shared_ptr<Node> > > > randomRuleWithDataSets;
+
+#ifndef NDEBUG
 	PRINTLN("Found the following possible rules :");
-	for(const auto& rule : possibleRules)
+	for(const auto* rule : possibleRules)
 	{
-		if(targetIndex == count)
-		{
-			randomRuleWithDataSets = rule;
-#ifdef NDEBUG
-			break;
+		PRINTLN("\t" + rule->name);
+	}
 #endif
-		}
-		++count;
-		PRINTLN("\t" + rule.first.name);
+	RulesWeights initializationRulesWeights; //A single pick, nothing to keep
+	initializationRule = &pickRule(DataManager::getInstance()->getInitializationRules(), possibleRules, ioRulesUsages, initializationRulesWeights);
+	PRINTLN("Randomly picked the " + initializationRule->name + " rule.");
+	++ioRulesUsages[initializationRule->name];
+}
+
+void Scheduler::run()
+{
+	PRINTLN("Creating initial narrative");
+	PRINT_SEPARATOR();
+	if(!initializationRule)
+	{
+		PRINTLN("No possible rules found. Generation failed.");
+		return; //TODO proper failure handling
 	}
-	auto& [name, socialConditions, storyConditions, storyGraph, nodeModificationArguments, appliesOnce] = randomRuleWithDataSets.first;
-	PRINTLN("Randomly picked the " + name + " rule.");
-	++rulesUsages[name];
-
-	randomIntDistribution = std::uniform_int_distribution{0, static_cast<int>(randomRuleWithDataSets.second.size()) - 1};
-	targetIndex = randomIntDistribution(randomEngine);
-	count = 0;
-	std::unordered_map<std::string, std::shared_ptr<Node> > cast;
-	std::list<std::shared_ptr<Node> > randomDataSet;
-	for(const auto& ruleDataSet : randomRuleWithDataSets.second)
+
+	Graph resultStory(questName, "Story_Graph");
+	resultStory.addNode(Node(Symbols::START_QUEST, {{Symbols::NODE_TYPE, {Symbols::STRING_TYPE, Symbols::START}}}));
+	resultStory.addNode(Node(Symbols::END_QUEST, {{Symbols::NODE_TYPE, {Symbols::STRING_TYPE, Symbols::END}}}));
+
+	const auto& worldGraph = DataManager::getInstance()->getWorldGraph();
+	const auto& [name, socialConditions, storyConditions, storyGraph, nodesModifications, socialNodesRolesSlots, storyNodesTargetsSlots, appliesOnce] = *initializationRule;
+
+	const auto& mappings = MatchCache::getInstance()->getMappings(worldGraph, socialConditions);
+	std::uniform_int_distribution<size_t> randomMappingDistribution{0, mappings.size() - 1};
+	const auto& randomDataSet = mappings[randomMappingDistribution(randomEngine)];
+	Cast cast;
+	for(size_t socialNodeIndex = 0; socialNodeIndex < randomDataSet.size(); ++socialNodeIndex)
 	{
-		if(targetIndex == count)
-		{
-			int i = 0;
-			for(const auto& socialNode : ruleDataSet)
-			{
-				cast[socialConditions.getNodeByIndex(i)->getName()] = socialNode;
-				++i;
-			}
-			randomDataSet = ruleDataSet;
-			break;
-		}
-		++count;
+		cast.setNodeIndex(socialNodesRolesSlots[socialNodeIndex], randomDataSet[socialNodeIndex]);
 	}
 
-	if(!cast.contains<std::string>("Player"))
+	if(!cast.contains(RoleTable::PLAYER_SLOT))
 	{
-		cast["Player"] = DataManager::getInstance()->getWorldGraph().getNodeByName("Player");
+		cast.setNodeIndex(RoleTable::PLAYER_SLOT, worldGraph.getNodeByName("Player")->getIndex());
 	}
 
-	const auto startingNode = resultStory.getNodesByIndex().begin()->second;
-	for(const auto& [socialNodeIndex, socialNode] : socialConditions.getNodesByIndex())
+	const auto* startingNode = resultStory.getNodeByIndex(0);
+	for(int socialNodeIndex = 0; socialNodeIndex < socialConditions.getNodeCount(); ++socialNodeIndex)
 	{
+		const auto* socialNode = socialConditions.getNodeByIndex(socialNodeIndex);
 		for(const auto& [attributeName, attributeData] : socialNode->getAttributes())
 		{
-			startingNode->getConditionsBlock()->preConditions.nodeConditions.emplace_back(NodeCondition{cast.at( socialNode->getName()), attributeName, attributeData.value, ComparisonType::Equal});
+			startingNode->getConditionsBlock()->preConditions.addNodeCondition(NodeCondition{cast.getNode(socialNodesRolesSlots[socialNodeIndex]), attributeName, attributeData, ComparisonType::Equal});
 		}
 
-		for(const auto& edge : socialNode->getOutgoingEdges())
+		for(const auto edgeHandle : socialNode->getOutgoingEdges())
 		{
-			startingNode->getConditionsBlock()->preConditions.edgeConditions.emplace_back(EdgeCondition{cast.at(edge->getSourceNode()->getName()), cast.at(edge->getTargetNode()->getName()), edge->getAttributes()});
+			const auto& edge = socialConditions.getEdge(edgeHandle);
+			startingNode->getConditionsBlock()->preConditions.addEdgeCondition(EdgeCondition{cast.getNode(socialNodesRolesSlots[edge.getSourceIndex()]), cast.getNode(socialNodesRolesSlots[edge.getTargetIndex()]), edge.getAttributes()});
 		}
 	}
 
@@ -103,247 +138,299 @@ void Scheduler::run()
 	printNodeConditions(startingNode->getName(), startingNode->getConditionsBlock());
 #endif
 
-	for(const auto& [storyNodeIndex, storyNode] : storyGraph.getNodesByIndex())
+	for(int storyNodeIndex = 0; storyNodeIndex < storyGraph.getNodeCount(); ++storyNodeIndex)
 	{
-		const auto index = socialConditions.getNodeByName(storyNode->getAttribute("target").value)->getIndex();
-		count = 0;
-		for(const auto& node : randomDataSet)
-		{
-			if(count == index)
-			{
-				const auto generatedNode = resultStory.addNode(new Node(*storyNode));
-				generatedNode->setAttribute("target", {"str", node->getName()});
-				createNodeConditions(nodeModificationArguments, cast, generatedNode);
-				generatedNode->clearEdges();
-				
-				break;
-			}
-			++count;
-		}
+		const auto* storyNode = storyGraph.getNodeByIndex(storyNodeIndex);
+		auto& generatedNode = resultStory.addNode(*storyNode);
+		resultStory.setNodeAttribute(generatedNode, Symbols::TARGET, {Symbols::STRING_TYPE, cast.getNode(storyNodesTargetsSlots[storyNodeIndex])->getNameSymbol()});
+		createNodeConditions(*nodesModifications[storyNodeIndex], cast, generatedNode);
 	}
 
 #ifndef NDEBUG
-	const auto lastNode = resultStory.getNodeByIndex(1);
+	const auto* lastNode = resultStory.getNodeByIndex(1);
 	printNodeConditions(lastNode->getName(), lastNode->getConditionsBlock());
 #endif
 
 
 	for(const auto& [storyEdgeNames, storyEdge] : storyGraph.getEdgesByNodesNames())
 	{
-		resultStory.addEdge({"N/A", "N/A"}, storyEdgeNames.first, storyEdgeNames.second);
+		resultStory.addEdge({Symbols::NOT_AVAILABLE, Symbols::NOT_AVAILABLE}, storyEdgeNames.first, storyEdgeNames.second);
 	}
-	resultStory.addEdge({"N/A", "N/A"}, 0, 2); //Between start node and first story node
-	resultStory.addEdge({"N/A", "N/A"}, resultStory.getNodeCount() - 1, 1);
+	resultStory.addEdge({Symbols::NOT_AVAILABLE, Symbols::NOT_AVAILABLE}, 0, 2); //Between start node and first story node
+	resultStory.addEdge({Symbols::NOT_AVAILABLE, Symbols::NOT_AVAILABLE}, resultStory.getNodeCount() - 1, 1);
 
 	std::unordered_map<std::string, int> rewriteRulesUsages;
-	for(const auto& [name, socialConditions, storyConditions, storyGraph, nodeModificationArguments, appliesOnce] : DataManager::getInstance()->getRewriteRules())
+	std::list<const Graph*> rewriteRulesStoryConditions;
+	for(const auto& [name, socialConditions, storyConditions, storyGraph, nodesModifications, socialNodesRolesSlots, storyNodesTargetsSlots, appliesOnce] : DataManager::getInstance()->getRewriteRules())
 	{
 		rewriteRulesUsages[name] = 0;
+		rewriteRulesStoryConditions.emplace_back(&storyConditions);
 	}
+	IncrementalMatcher storyMatcher(resultStory, rewriteRulesStoryConditions);
 
 	bool canRewrite = true;
 	int rewriteCount = 0;
-	Graph& finalStory = resultStory;
-	Graph tempStory;
 	while(canRewrite && rewriteCount < DataManager::getInstance()->getTestLayout().maxNumberOfRewrites)
 	{
-		canRewrite = rewriteStory(finalStory, cast, rewriteRulesUsages, tempStory);
-		finalStory = tempStory;
+		canRewrite = rewriteStory(resultStory, cast, rewriteRulesUsages, storyMatcher);
 		++rewriteCount;
 	}
 	PRINTLN("Stopped rewriting: " + std::string(canRewrite ? "Max rewrite count reached." : "No rewrite rules available."));
 
-	finalStory.saveAsDotFile();
+	OutputPipeline::getInstance()->save(std::move(resultStory));
 }
 
-void Scheduler::getPossibleRules(const std::list<Rule>& inRuleSet, const Graph& inGraph, const std::unordered_map<std::string, int>& inRuleUsages, std::unordered_map<Rule, std::list<std::list<std::shared_ptr<Node> > >, RuleHashFunction>& outPossibleRules)
+void Scheduler::getPossibleRules(const std::list<Rule>& inRuleSet, const std::unordered_map<std::string, int>& inRuleUsages, const std::function<bool(const Rule&)>& inIsPossible, std::vector<const Rule*>& outPossibleRules)
 {
+	//Rules are checked concurrently, then gathered in rule set order so that the result doesn't depend on scheduling
+	auto* threadPool = ThreadPool::getInstance();
+	const auto rulesChecks = threadPool->createTaskGroup();
+	std::vector<std::pair<const Rule*, std::future<bool> > > rulesPossibilities;
 	for(const auto& rule : inRuleSet)
 	{
-
 		if(!rule.appliesOnce || !inRuleUsages.at(rule.name))
 		{
-			std::list<std::list<std::shared_ptr<Node> > > dataSet;
-			if(inGraph.getType() == "Social_Graph")
-			{
-				inGraph.getIsomorphicSubGraphs(rule.socialConditions, dataSet);
-			}
-			else if(inGraph.getType() == "Story_Graph") 
-			{
-				inGraph.getIsomorphicSubGraphs(rule.storyConditions, dataSet);
-			}
-			else
+			rulesPossibilities.emplace_back(&rule, threadPool->submit(rulesChecks, [&inIsPossible, &rule](){ return inIsPossible(rule); }));
+		}
+	}
+
+	for(auto& [rule, isPossible] : rulesPossibilities)
+	{
+		if(threadPool->wait(rulesChecks, isPossible))
+		{
+			outPossibleRules.emplace_back(rule);
+		}
+	}
+}
+
+const Rule& Scheduler::pickRule(const std::list<Rule>& inRuleSet, const std::vector<const Rule*>& inPossibleRules, const std::unordered_map<std::string, int>& inRuleUsages, RulesWeights& ioRulesWeights)
+{
+	if(!DataManager::getInstance()->getTestLayout().bWeightRulesByMetrics)
+	{
+		return *inPossibleRules[std::uniform_int_distribution{0, static_cast<int>(inPossibleRules.size()) - 1}(randomEngine)];
+	}
+
+	auto& [rules, sampler, weightedUsages] = ioRulesWeights;
+	if(rules.empty())
+	{
+		for(const auto& rule : inRuleSet)
+		{
+			rules.emplace_back(&rule);
+		}
+		sampler = WeightedSampler(std::vector<double>(rules.size(), 0.));
+		weightedUsages.assign(rules.size(), NONE);
+	}
+	assert(sampler.getSize() == inRuleSet.size());
+
+	//Both are in rule set order, the possible rules are found while walking the rule set
+	auto possibleRule = inPossibleRules.begin();
+	for(size_t rulePosition = 0; rulePosition < rules.size(); ++rulePosition)
+	{
+		if(possibleRule != inPossibleRules.end() && *possibleRule == rules[rulePosition])
+		{
+			++possibleRule;
+			if(const auto ruleUsages = inRuleUsages.at(rules[rulePosition]->name); weightedUsages[rulePosition] != ruleUsages)
 			{
-				assert(false);
+				sampler.setWeight(rulePosition, getRuleWeight(*rules[rulePosition], ruleUsages));
+				weightedUsages[rulePosition] = ruleUsages;
 			}
-			if(!dataSet.empty())
+		}
+		else if(weightedUsages[rulePosition] != NONE)
+		{
+			sampler.setWeight(rulePosition, 0.);
+			weightedUsages[rulePosition] = NONE;
+		}
+	}
+	assert(possibleRule == inPossibleRules.end());
+	return *rules[sampler.sample(randomEngine)];
+}
+
+double Scheduler::getRuleWeight(const Rule& inRule, const int inRuleUsages)
+{
+	//Each metric to optimize scales the weight by (1 + estimate) ^ metric weight, so that rules expected to raise a metric with a positive weight are favored,
+	//and those expected to raise a metric with a negative weight avoided
+	static const Symbol nodeTypeAttributeName("nodetype");
+	static const Symbol fightNodeType("Fight");
+	double weight = 1.;
+	for(const auto& [metricName, metricWeight] : DataManager::getInstance()->getTestLayout().metricsToOptimize)
+	{
+		double estimate = 0.;
+		if(metricName == "repetitivity")
+		{
+			estimate = inRuleUsages;
+		}
+		else if(metricName == "fights" || metricName == "num_branches")
+		{
+			for(int storyNodeIndex = 0; storyNodeIndex < inRule.storyGraph.getNodeCount(); ++storyNodeIndex)
 			{
-				outPossibleRules[rule] = dataSet;
+				const auto* storyNode = inRule.storyGraph.getNodeByIndex(storyNodeIndex);
+				if(metricName == "num_branches")
+				{
+					estimate += storyNode->getOutgoingEdges().size() > 1 ? 1. : 0.;
+				}
+				else if(const auto nodeType = storyNode->getAttributes().find(nodeTypeAttributeName); nodeType != storyNode->getAttributes().end() && nodeType->second.getText() == fightNodeType)
+				{
+					++estimate;
+				}
 			}
 		}
+		else if(metricName == "longest_path")
+		{
+			estimate = std::max(0, inRule.storyGraph.getNodeCount() - inRule.storyConditions.getNodeCount()); //Nodes the rule adds to the story
+		}
+		else
+		{
+			continue; //Can't be estimated before the rule is applied
+		}
+		weight *= std::pow(1. + estimate, metricWeight);
 	}
+	return weight;
 }
 
-bool Scheduler::rewriteStory(const Graph& inStory, const std::unordered_map<std::string, std::shared_ptr<Node>>& inCast, std::unordered_map<std::string, int>& inRuleUsages, Graph& outStory)
+bool Scheduler::rewriteStory(Graph& ioStory, const Cast& inCast, std::unordered_map<std::string, int>& inRuleUsages, IncrementalMatcher& ioStoryMatcher)
 {
 	PRINTLN("");
 	PRINTLN("Attempting to rewrite");
 	PRINT_SEPARATOR();
 	PRINTLN("Checking rewrite rules...");
-	Graph tempStory(inStory);
-	std::unordered_map<Rule, std::list<std::list<std::shared_ptr<Node> > >, RuleHashFunction> possibleRewriteRules;
-	getPossibleRules(DataManager::getInstance()->getRewriteRules(), tempStory, inRuleUsages, possibleRewriteRules);
+	ioStoryMatcher.update(ioStory); //Only searches around the nodes modified by the last accepted rewrite
+	std::vector<const Rule*> possibleRewriteRules;
+	getPossibleRules(DataManager::getInstance()->getRewriteRules(), inRuleUsages, [&ioStoryMatcher](const Rule& inRule)
+	{
+		return !ioStoryMatcher.getMappings(inRule.storyConditions).empty();
+	}, possibleRewriteRules);
 
-	bool storyRewritten = false;
 	if(!possibleRewriteRules.empty())
 	{
 		PRINTLN("Found " + std::to_string(possibleRewriteRules.size()) + " possible rewrite rules.");
-		std::uniform_int_distribution randomIntDistribution = std::uniform_int_distribution{0, static_cast<int>(possibleRewriteRules.size()) - 1};
-		int targetIndex = randomIntDistribution(randomEngine);
-		int count = 0;
-		std::pair<Rule, std::list<std::list<std::shared_ptr<Node> > > > rewriteRuleWithDataSets;
-		for(const auto& rule : possibleRewriteRules)
-		{
-			if(targetIndex == count)
-			{
-				rewriteRuleWithDataSets = rule;
-				break;
-			}
-			++count;
-		}
-
-		auto& [rewriteRuleName, rewriteRuleSocialConditions, rewriteRuleStoryConditions, rewriteRuleStoryGraph, rewriteRuleNodeModificationArguments, rewriteRuleAppliesOnce] = rewriteRuleWithDataSets.first;
+		const auto& [rewriteRuleName, rewriteRuleSocialConditions, rewriteRuleStoryConditions, rewriteRuleStoryGraph, rewriteRuleNodesModifications, rewriteRuleSocialNodesRolesSlots, rewriteRuleStoryNodesTargetsSlots, rewriteRuleAppliesOnce] = pickRule(DataManager::getInstance()->getRewriteRules(), possibleRewriteRules, inRuleUsages, rewriteRulesWeights);
 		PRINTLN("Picked the " + rewriteRuleName + " rewrite rule.");
 		++inRuleUsages[rewriteRuleName];
 		
-		for(const auto& [socialNodeName, socialNode] : rewriteRuleSocialConditions.getNodesByName())
+		//Social nodes already part of the cast must be played by the same actors
+		std::vector<std::pair<int, int> > castedSocialNodes; //Social node index and index of the world node playing it
+		for(int socialNodeIndex = 0; socialNodeIndex < rewriteRuleSocialConditions.getNodeCount(); ++socialNodeIndex)
 		{
-			if(auto foundNode = inCast.find<std::string>(socialNodeName); foundNode != inCast.end())
+			if(const auto roleSlot = rewriteRuleSocialNodesRolesSlots[socialNodeIndex]; inCast.contains(roleSlot))
 			{
-				socialNode->setAttribute("name", {"str", foundNode->second->getName()});
+				castedSocialNodes.emplace_back(socialNodeIndex, inCast.getNodeIndex(roleSlot));
 			}
 		}
 
-		std::list<std::list<std::shared_ptr<Node> > > possibleRewriteRuleCasts;
-		DataManager::getInstance()->getWorldGraph().getIsomorphicSubGraphs(rewriteRuleSocialConditions, possibleRewriteRuleCasts);
-
-		if(!possibleRewriteRuleCasts.empty())
+		const auto& worldGraph = DataManager::getInstance()->getWorldGraph();
+		std::vector<const std::vector<int>*> possibleRewriteRuleMappings;
+		for(const auto& mapping : MatchCache::getInstance()->getMappings(worldGraph, rewriteRuleSocialConditions))
 		{
-			randomIntDistribution = std::uniform_int_distribution{0, static_cast<int>(rewriteRuleWithDataSets.second.size()) - 1};
-			targetIndex = randomIntDistribution(randomEngine);
-			count = 0;
-			std::list<std::shared_ptr<Node> > rewriteRuleDataSet; //This is the node(s) that could be replaced by the rewrite rule
-			for(const auto& dataSet : rewriteRuleWithDataSets.second)
-			{
-				if(targetIndex == count)
+			if
+			(
+				std::ranges::all_of(castedSocialNodes, [&mapping](const std::pair<int, int>& inCastedSocialNode)
 				{
-					rewriteRuleDataSet = dataSet;
-					break;
-				}
-				++count;
-			}
-
-			randomIntDistribution = std::uniform_int_distribution{0, static_cast<int>(possibleRewriteRuleCasts.size()) - 1};
-			targetIndex = randomIntDistribution(randomEngine);
-			count = 0;
-			std::list<std::shared_ptr<Node> > rewriteRuleCast; //This is the objects that will be used to fill RewriteRule Story targets, with missing NPCs added to cast 
-			for(const auto& dataSet : possibleRewriteRuleCasts)
+					return mapping[inCastedSocialNode.first] == inCastedSocialNode.second;
+				})
+			)
 			{
-				if(targetIndex == count)
-				{
-					rewriteRuleCast = dataSet;
-					break;
-				}
-				++count;
+				possibleRewriteRuleMappings.emplace_back(&mapping);
 			}
+		}
+
+		if(!possibleRewriteRuleMappings.empty())
+		{
+			const auto& rewriteRuleMapping = *possibleRewriteRuleMappings[std::uniform_int_distribution<size_t>{0, possibleRewriteRuleMappings.size() - 1}(randomEngine)];
+			const auto& storyMappings = ioStoryMatcher.getMappings(rewriteRuleStoryConditions);
+			const auto& rewriteRuleDataSet = storyMappings[std::uniform_int_distribution<size_t>{0, storyMappings.size() - 1}(randomEngine)]; //This is the node(s) that could be replaced by the rewrite rule
 
-			count = 0;
+			//Social nodes not yet part of the cast are played by the actors of the picked mapping, that will be used to fill RewriteRule Story targets
 			auto tempCast(inCast);
-			for(const auto& node : rewriteRuleCast)
+			for(size_t socialNodeIndex = 0; socialNodeIndex < rewriteRuleMapping.size(); ++socialNodeIndex)
 			{
-				const auto socialNodeName = rewriteRuleSocialConditions.getNodeByIndex(count)->getName();
-				if(auto foundActor = tempCast.find<std::string>(rewriteRuleSocialConditions.getNodeByIndex(count)->getName()); foundActor == tempCast.end())
+				if(const auto roleSlot = rewriteRuleSocialNodesRolesSlots[socialNodeIndex]; !tempCast.contains(roleSlot))
 				{
-					tempCast[socialNodeName] = node;
+					tempCast.setNodeIndex(roleSlot, rewriteRuleMapping[socialNodeIndex]);
 				}
-				++count;
 			}
 
-			const auto rewriteStartNode = *rewriteRuleDataSet.begin();
-			const auto rewriteEndNode = *--rewriteRuleDataSet.end();
+			//The story is modified in place, and reverted if the rewritten story isn't valid
+			ioStory.beginTransaction();
+			const auto rewriteStartNodeIndex = rewriteRuleDataSet.front();
+			const auto rewriteEndNodeIndex = rewriteRuleDataSet.back();
 
-			std::list<std::shared_ptr<Node> > nodesPreviouslyConnectedToRewriteStartNode;
-			std::list<std::shared_ptr<Node> > nodesPreviouslyConnectedToRewriteEndNode;
+			std::list<int> nodesPreviouslyConnectedToRewriteStartNode;
+			std::list<int> nodesPreviouslyConnectedToRewriteEndNode;
 
-			while(!rewriteStartNode->getIncomingEdges().empty())
+			for(const auto* rewriteStartNode = ioStory.getNodeByIndex(rewriteStartNodeIndex); !rewriteStartNode->getIncomingEdges().empty();)
 			{
-				auto incomingEdge = *rewriteStartNode->getIncomingEdges().begin();
-				nodesPreviouslyConnectedToRewriteStartNode.emplace_back(incomingEdge->getSourceNode());
-				tempStory.removeEdge(incomingEdge);
+				const auto sourceNodeIndex = ioStory.getEdge(rewriteStartNode->getIncomingEdges().front()).getSourceIndex();
+				nodesPreviouslyConnectedToRewriteStartNode.emplace_back(sourceNodeIndex);
+				ioStory.removeEdge(sourceNodeIndex, rewriteStartNodeIndex);
 			}
-			while(!rewriteEndNode->getOutgoingEdges().empty())
+			for(const auto* rewriteEndNode = ioStory.getNodeByIndex(rewriteEndNodeIndex); !rewriteEndNode->getOutgoingEdges().empty();)
 			{
-				auto outgoingEdge = *rewriteEndNode->getOutgoingEdges().begin();
-				nodesPreviouslyConnectedToRewriteEndNode.emplace_back(outgoingEdge->getTargetNode());
-				tempStory.removeEdge(outgoingEdge);
+				const auto targetNodeIndex = ioStory.getEdge(rewriteEndNode->getOutgoingEdges().front()).getTargetIndex();
+				nodesPreviouslyConnectedToRewriteEndNode.emplace_back(targetNodeIndex);
+				ioStory.removeEdge(rewriteEndNodeIndex, targetNodeIndex);
+			}
+			ioStory.removeNode(rewriteStartNodeIndex);
+			if(rewriteEndNodeIndex != rewriteStartNodeIndex) //Single node rewrites start and end on the same node
+			{
+				ioStory.removeNode(rewriteEndNodeIndex);
 			}
-			tempStory.removeNode(rewriteStartNode);
-			tempStory.removeNode(rewriteEndNode);
 
-			std::unordered_map<std::string, std::string > newNameDictionary;
-			std::unordered_map<std::string, std::list<CommandData> > copyOfRewriteRuleNodeModificationArguments; //Improve this ugly fix
-			for(auto [storyNodeName, storyNode] : rewriteRuleStoryGraph.getNodesByName())
+			std::unordered_map<Symbol, Symbol> newNameDictionary;
+			for(int storyNodeIndex = 0; storyNodeIndex < rewriteRuleStoryGraph.getNodeCount(); ++storyNodeIndex) //In index order, the order of the names would depend on the order in which the symbols were interned
 			{
-				auto* generatedNode = new Node(*storyNode);
-				auto newName = generatedNode->getName();
-				while(tempStory.getNodesByName().contains<std::string>(newName))
+				const auto* storyNode = rewriteRuleStoryGraph.getNodeByIndex(storyNodeIndex);
+				auto generatedNode(*storyNode);
+				auto newName = generatedNode.getName();
+				while(ioStory.getNodesByName().contains(newName))
 				{
 					newName += "_";
 				}
 
-				newNameDictionary[storyNodeName] = newName;
-				copyOfRewriteRuleNodeModificationArguments[newName] = rewriteRuleNodeModificationArguments[storyNodeName];
-				generatedNode->setName(newName);
+				newNameDictionary[storyNode->getNameSymbol()] = newName;
+				generatedNode.setName(newName);
 
-				auto addedNode = tempStory.addNode(generatedNode);
-				addedNode->setAttribute("target", {"str", tempCast[storyNode->getAttribute("target").value]->getName()});
-				addedNode->clearEdges();
+				auto& addedNode = ioStory.addNode(std::move(generatedNode));
+				ioStory.setNodeAttribute(addedNode, Symbols::TARGET, {Symbols::STRING_TYPE, tempCast.getNode(rewriteRuleStoryNodesTargetsSlots[storyNodeIndex])->getNameSymbol()});
 				if(storyNode->getIncomingEdges().empty())
 				{
-					for(const auto& nodePreviouslyConnectedToRewriteStartNode : nodesPreviouslyConnectedToRewriteStartNode)
+					for(const auto nodePreviouslyConnectedToRewriteStartNode : nodesPreviouslyConnectedToRewriteStartNode)
 					{
-						tempStory.addEdge({"N/A", "N/A"}, nodePreviouslyConnectedToRewriteStartNode, addedNode);
+						ioStory.addEdge({Symbols::NOT_AVAILABLE, Symbols::NOT_AVAILABLE}, nodePreviouslyConnectedToRewriteStartNode, addedNode.getIndex());
 					}
 				}
 				if(storyNode->getOutgoingEdges().empty())
 				{
-					for(const auto& nodePreviouslyConnectedToRewriteEndNode : nodesPreviouslyConnectedToRewriteEndNode)
+					for(const auto nodePreviouslyConnectedToRewriteEndNode : nodesPreviouslyConnectedToRewriteEndNode)
 					{
-						tempStory.addEdge({"N/A", "N/A"}, addedNode, nodePreviouslyConnectedToRewriteEndNode);
+						ioStory.addEdge({Symbols::NOT_AVAILABLE, Symbols::NOT_AVAILABLE}, addedNode.getIndex(), nodePreviouslyConnectedToRewriteEndNode);
 					}
 				}
-				createNodeConditions(copyOfRewriteRuleNodeModificationArguments, tempCast, addedNode);
+				createNodeConditions(*rewriteRuleNodesModifications[storyNodeIndex], tempCast, addedNode);
 			}
 
 
 			for(const auto& [storyEdgeNames, storyEdge] : rewriteRuleStoryGraph.getEdgesByNodesNames())
 			{
-				tempStory.addEdge({"N/A", "N/A"},  newNameDictionary[storyEdgeNames.first], newNameDictionary[storyEdgeNames.second]);
+				ioStory.addEdge({Symbols::NOT_AVAILABLE, Symbols::NOT_AVAILABLE}, newNameDictionary[storyEdgeNames.first], newNameDictionary[storyEdgeNames.second]);
 			}
 
-			auto lastNode = tempStory.getNodeByIndex(1);
-			lastNode->validateNode({}, true);
-			storyRewritten = lastNode->isValid();
+			ioStory.validateNode(1);
+			const auto storyRewritten = ioStory.getNodeByIndex(1)->isValid();
 			PRINTLN("Story valid ? " + std::to_string(storyRewritten));
-
+			if(storyRewritten)
+			{
+				ioStory.commitTransaction();
+			}
+			else
+			{
+				ioStory.rollbackTransaction();
+			}
 		}
 	}
 	else
 	{
-		outStory = inStory;
 		return false;
 	}
-	outStory = storyRewritten ? tempStory : inStory;
 	return true;
 }
 
@@ -358,18 +445,15 @@ void Scheduler::printNodeConditions(const std::string& inNodeName, const std::sh
 }
 #endif
 
-void Scheduler::createNodeConditions(const std::unordered_map<std::string, std::list<CommandData> >& inRuleCommandsData, const std::unordered_map<std::string, std::shared_ptr<Node> >& inCast, const std::shared_ptr<Node> inNode)  // NOLINT(performance-unnecessary-value-param)
+void Scheduler::createNodeConditions(const std::vector<CompiledCommand>& inCommands, const Cast& inCast, const Node& inNode)
 {
 	ConditionsBlock conditionsBlock;
-	if(const auto& commandsData = inRuleCommandsData.find<std::string>(inNode->getName()); commandsData != inRuleCommandsData.end())
+	for(const auto& command : inCommands)
 	{
-		for(const auto& commandData : commandsData->second)
-		{
-			conditionsBlock.append(CommandRegistry::getInstance()->getCommandConditions(inCast,  commandData));
-		}
+		conditionsBlock.append(CommandRegistry::getCommandConditions(inCast, command));
 	}
-	inNode->setConditionsBlock(conditionsBlock);
+	inNode.setConditionsBlock(conditionsBlock);
 #ifndef NDEBUG
-	printNodeConditions(inNode->getName(), inNode->getConditionsBlock());
+	printNodeConditions(inNode.getName(), inNode.getConditionsBlock());
 #endif
 }
\ No newline at end of file
@@ -0,0 +1,276 @@
+#include "SubGraphMatcher.h"
+
+#include <algorithm>
+
+#include "GraphSnapshot.h"
+
+SubGraphMatcher::SubGraphMatcher(const Graph& inGraph, const Graph& inSearchedGraph, const int inAnchoredSearchedNodeIndex, const int inAnchorNodeIndex) :
+	graph(inGraph),
+	searchedGraph(inSearchedGraph),
+	snapshot(inGraph.getSnapshot()),
+	plan(nullptr),
+	wordCount(BitMatrix::toWordCount(inGraph.nodeCount)),
+	subNodes(inSearchedGraph.nodeCount, inGraph.nodeCount),
+	feasibleSubNodes(inSearchedGraph.nodeCount, inGraph.nodeCount),
+	usedNodes(wordCount, 0),
+	mapping(inSearchedGraph.nodeCount, NONE),
+	mappedCount(0),
+	nextCandidates(inSearchedGraph.nodeCount, 0),
+	bHasStarted(false),
+	bIsExhausted(!inSearchedGraph.nodeCount)
+{
+	//An anchored search starts from its anchor, others follow the plan compiled with the rules, or plan on their own if there is none
+	if(const auto* compiledPlan = inSearchedGraph.getMatchPlan(); compiledPlan && inAnchoredSearchedNodeIndex == NONE)
+	{
+		plan = compiledPlan;
+	}
+	else
+	{
+		ownPlan = inSearchedGraph.createMatchPlan(nullptr, inAnchoredSearchedNodeIndex);
+		plan = &ownPlan;
+	}
+
+	//Find subNodes for each nodes of searched graph
+	for(int row = 0; row < searchedGraph.nodeCount; ++row)
+	{
+		if(const auto* subNode = searchedGraph.getNodeByIndex(row))
+		{
+			if(row != inAnchoredSearchedNodeIndex)
+			{
+				findSubNodes(row, *subNode);
+			}
+			else if(const auto* anchorNode = graph.getNodeByIndex(inAnchorNodeIndex); anchorNode && anchorNode->containsAttributes(*subNode) && hasSubNodeEdges(inAnchorNodeIndex, *subNode))
+			{
+				subNodes.set(row, inAnchorNodeIndex);
+			}
+		}
+	}
+
+	bIsExhausted = bIsExhausted || !refineSubNodes();
+}
+
+bool SubGraphMatcher::next()
+{
+	if(bIsExhausted)
+	{
+		return false;
+	}
+
+	if(bHasStarted) //Resume the search right after the last complete mapping
+	{
+		popMapping();
+	}
+	else
+	{
+		bHasStarted = true;
+		computeFeasibleSubNodes(0);
+	}
+
+	//Extend the partial mapping one searched node at a time, backtracking as soon as a searched node has no candidate left
+	const auto columnCount = wordCount * BitMatrix::WORD_SIZE;
+	while(true)
+	{
+		const int step = mappedCount;
+		const auto* feasibleRow = feasibleSubNodes.getRow(step);
+		auto candidateIndex = BitMatrix::findNextSetBit(feasibleRow, wordCount, nextCandidates[step]);
+		while(candidateIndex < columnCount && !isMappingConsistent(static_cast<int>(candidateIndex)))
+		{
+			candidateIndex = BitMatrix::findNextSetBit(feasibleRow, wordCount, candidateIndex + 1);
+		}
+
+		if(candidateIndex >= columnCount)
+		{
+			if(!step)
+			{
+				bIsExhausted = true;
+				return false;
+			}
+			popMapping();
+			continue;
+		}
+
+		nextCandidates[step] = candidateIndex + 1;
+		pushMapping(static_cast<int>(candidateIndex));
+		if(mappedCount == searchedGraph.nodeCount)
+		{
+			assert(isMappingInjective());
+			return true;
+		}
+		computeFeasibleSubNodes(mappedCount);
+	}
+}
+
+const std::vector<int>& SubGraphMatcher::getMapping() const
+{
+	return mapping;
+}
+
+void SubGraphMatcher::getSubNodes(std::list<const Node*>& outFoundSubNodes) const
+{
+	for(const auto nodeIndex : mapping)
+	{
+		outFoundSubNodes.emplace_back(graph.getNodeByIndex(nodeIndex));
+	}
+}
+
+void SubGraphMatcher::findSubNodes(const int inSearchedNodeIndex, const Node& inSearchedNode)
+{
+	if(inSearchedNode.getAttributes().empty())
+	{
+		for(int nodeIndex = 0; nodeIndex < graph.nodeCount; ++nodeIndex)
+		{
+			if(hasSubNodeEdges(nodeIndex, inSearchedNode))
+			{
+				subNodes.set(inSearchedNodeIndex, nodeIndex);
+			}
+		}
+		return;
+	}
+
+	//Nodes holding every searched attribute are the intersection of the attribute posting lists, starting from the shortest one
+	std::vector<const std::vector<int>*> nodesIndexesByAttribute;
+	nodesIndexesByAttribute.reserve(inSearchedNode.getAttributes().size());
+	for(const auto& [attributeName, attributeData] : inSearchedNode.getAttributes())
+	{
+		nodesIndexesByAttribute.emplace_back
+		(
+			attributeName == Symbols::TARGET || attributeData.getText() == Symbols::NOT_AVAILABLE //TODO make virtual method for story nodes after template hell is done
+				? &graph.getNodesIndexesWithAttribute(attributeName)
+				: &graph.getNodesIndexesWithAttribute(attributeName, attributeData.getText())
+		);
+	}
+	std::ranges::sort(nodesIndexesByAttribute, {}, [](const std::vector<int>* inNodesIndexes){ return inNodesIndexes->size(); });
+
+	for(const auto nodeIndex : *nodesIndexesByAttribute.front())
+	{
+		if
+		(
+			std::all_of(nodesIndexesByAttribute.begin() + 1, nodesIndexesByAttribute.end(), [nodeIndex](const std::vector<int>* inNodesIndexes)
+			{
+				return std::ranges::binary_search(*inNodesIndexes, nodeIndex);
+			})
+			&& hasSubNodeEdges(nodeIndex, inSearchedNode)
+		)
+		{
+			subNodes.set(inSearchedNodeIndex, nodeIndex);
+		}
+	}
+}
+
+bool SubGraphMatcher::hasSubNodeEdges(const int inNodeIndex, const Node& inSearchedNode) const
+{
+	if(snapshot)
+	{
+		const auto incomingEdges = snapshot->getIncomingEdges(inNodeIndex);
+		const auto outgoingEdges = snapshot->getOutgoingEdges(inNodeIndex);
+		return snapshot->hasNode(inNodeIndex) && incomingEdges.size() >= inSearchedNode.getIncomingEdges().size()
+			&& outgoingEdges.size() >= inSearchedNode.getOutgoingEdges().size()
+			&& snapshot->containsEdges(incomingEdges, searchedGraph, inSearchedNode.getIncomingEdges())
+			&& snapshot->containsEdges(outgoingEdges, searchedGraph, inSearchedNode.getOutgoingEdges());
+	}
+
+	const auto* node = graph.getNodeByIndex(inNodeIndex);
+	return node && node->getIncomingEdges().size() >= inSearchedNode.getIncomingEdges().size()
+		&& node->getOutgoingEdges().size() >= inSearchedNode.getOutgoingEdges().size()
+		&& graph.containsEdges(node->getIncomingEdges(), searchedGraph, inSearchedNode.getIncomingEdges())
+		&& graph.containsEdges(node->getOutgoingEdges(), searchedGraph, inSearchedNode.getOutgoingEdges());
+}
+
+bool SubGraphMatcher::refineSubNodes()
+{
+	//Ullmann refinement: a node can only stand for a searched node if each neighbour of the searched node still has a candidate among the node's neighbours
+	const auto searchedWordCount = BitMatrix::toWordCount(searchedGraph.nodeCount);
+	bool changed = true;
+	while(changed)
+	{
+		changed = false;
+		for(int row = 0; row < searchedGraph.nodeCount; ++row)
+		{
+			auto* subNodesRow = subNodes.getRow(row);
+			BitMatrix::forEachSetBit(subNodesRow, wordCount, [&](const size_t inColumn)
+			{
+				bool isFeasible = true;
+				BitMatrix::forEachSetBit(searchedGraph.adjacencyList.getRow(row), searchedWordCount, [&](const size_t inSearchedTarget)
+				{
+					isFeasible = isFeasible && BitMatrix::intersects(subNodes.getRow(inSearchedTarget), graph.adjacencyList.getRow(inColumn), wordCount);
+				});
+				BitMatrix::forEachSetBit(searchedGraph.incomingAdjacencyList.getRow(row), searchedWordCount, [&](const size_t inSearchedSource)
+				{
+					isFeasible = isFeasible && BitMatrix::intersects(subNodes.getRow(inSearchedSource), graph.incomingAdjacencyList.getRow(inColumn), wordCount);
+				});
+				if(!isFeasible)
+				{
+					BitMatrix::reset(subNodesRow, inColumn);
+					changed = true;
+				}
+			});
+
+			if(!BitMatrix::count(subNodesRow, wordCount)) //A searched node without any candidate can't be part of any mapping
+			{
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+void SubGraphMatcher::computeFeasibleSubNodes(const int inStep)
+{
+	//Candidates are the unused subNodes that are adjacent, in the right direction, to every already mapped neighbour
+	auto* feasibleRow = feasibleSubNodes.getRow(inStep);
+	std::copy_n(subNodes.getRow(plan->nodesIndexes[inStep]), wordCount, feasibleRow);
+	BitMatrix::andNotRows(feasibleRow, usedNodes.data(), wordCount);
+	for(const auto& [step, bIsOutgoing, edge] : plan->edgeChecks[inStep])
+	{
+		const auto mappedNodeIndex = mapping[plan->nodesIndexes[step]];
+		BitMatrix::andRows(feasibleRow, bIsOutgoing ? graph.incomingAdjacencyList.getRow(mappedNodeIndex) : graph.adjacencyList.getRow(mappedNodeIndex), wordCount);
+	}
+	nextCandidates[inStep] = 0;
+}
+
+bool SubGraphMatcher::isMappingConsistent(const int inCandidateIndex) const
+{
+	//Adjacency is already guaranteed by the candidates filtering, only the labels of edges toward already mapped nodes are left to check
+	for(const auto& [step, bIsOutgoing, edge] : plan->edgeChecks[mappedCount])
+	{
+		const auto mappedNodeIndex = mapping[plan->nodesIndexes[step]];
+		const auto& searchedEdge = searchedGraph.edges[edge];
+		if(snapshot)
+		{
+			if(!snapshot->containsEdgeAttribute(bIsOutgoing ? snapshot->findEdge(inCandidateIndex, mappedNodeIndex) : snapshot->findEdge(mappedNodeIndex, inCandidateIndex), searchedEdge))
+			{
+				return false;
+			}
+			continue;
+		}
+
+		const auto candidateEdge = bIsOutgoing ? graph.edgesByNodesIndex.at({inCandidateIndex, mappedNodeIndex}) : graph.edgesByNodesIndex.at({mappedNodeIndex, inCandidateIndex});
+		if(!graph.edges[candidateEdge].containsAttribute(searchedEdge))
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+void SubGraphMatcher::pushMapping(const int inNodeIndex)
+{
+	BitMatrix::set(usedNodes.data(), inNodeIndex);
+	mapping[plan->nodesIndexes[mappedCount]] = inNodeIndex;
+	++mappedCount;
+}
+
+void SubGraphMatcher::popMapping()
+{
+	--mappedCount;
+	auto& mappedNodeIndex = mapping[plan->nodesIndexes[mappedCount]];
+	BitMatrix::reset(usedNodes.data(), mappedNodeIndex);
+	mappedNodeIndex = NONE;
+}
+
+bool SubGraphMatcher::isMappingInjective() const
+{
+	auto mappedNodesIndexes = mapping;
+	std::ranges::sort(mappedNodesIndexes);
+	return std::ranges::adjacent_find(mappedNodesIndexes) == mappedNodesIndexes.end();
+}
@@ -0,0 +1,62 @@
+#include "Symbol.h"
+
+Symbol::Symbol() : id(0)
+{
+}
+
+Symbol::Symbol(const char* inString) : Symbol(std::string_view(inString))
+{
+}
+
+Symbol::Symbol(const std::string& inString) : Symbol(std::string_view(inString))
+{
+}
+
+Symbol::Symbol(const std::string_view inString) : id(SymbolTable::getInstance()->intern(inString))
+{
+}
+
+const std::string& Symbol::getString() const
+{
+	return SymbolTable::getInstance()->getString(id);
+}
+
+uint32_t Symbol::getId() const
+{
+	return id;
+}
+
+SymbolTable::SymbolTable() : symbolCount(0)
+{
+	intern(""); //Default constructed symbols are the empty string
+}
+
+uint32_t SymbolTable::intern(const std::string_view inString)
+{
+	std::lock_guard lock(internMutex);
+	if(const auto foundId = ids.find(inString); foundId != ids.end())
+	{
+		return foundId->second;
+	}
+
+	assert(symbolCount < CHUNK_SIZE * CHUNK_COUNT);
+	auto& chunk = chunks[symbolCount / CHUNK_SIZE];
+	if(!chunk)
+	{
+		chunk = std::make_unique<std::string[]>(CHUNK_SIZE);
+	}
+	const auto& internedString = chunk[symbolCount % CHUNK_SIZE] = inString;
+	ids.emplace(internedString, symbolCount);
+	return symbolCount++;
+}
+
+const std::string& SymbolTable::getString(const uint32_t inId) const
+{
+	return chunks[inId / CHUNK_SIZE][inId % CHUNK_SIZE];
+}
+
+uint32_t SymbolTable::getSymbolCount() const
+{
+	std::lock_guard lock(internMutex);
+	return symbolCount;
+}
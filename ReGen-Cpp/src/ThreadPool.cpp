@@ -0,0 +1,71 @@
+#include "ThreadPool.h"
+
+#include <algorithm>
+
+ThreadPool::ThreadPool() : workerCount(0), targetWorkerCount(0), nextGroup(0)
+{
+	setThreadCount(0);
+}
+
+ThreadPool::TaskGroup ThreadPool::createTaskGroup()
+{
+	return nextGroup++;
+}
+
+size_t ThreadPool::getThreadCount() const
+{
+	std::lock_guard lock(tasksMutex);
+	return targetWorkerCount + 1;
+}
+
+void ThreadPool::setThreadCount(const size_t inThreadCount)
+{
+	//The thread waiting for results also runs tasks, hence one less worker than threads
+	const auto threadCount = inThreadCount > 0 ? inThreadCount : std::max(std::thread::hardware_concurrency(), 2u);
+	{
+		std::lock_guard lock(tasksMutex);
+		targetWorkerCount = threadCount - 1;
+		for(; workerCount < targetWorkerCount; ++workerCount)
+		{
+			std::thread(&ThreadPool::work, this).detach(); //The pool lives as long as the process
+		}
+	}
+	tasksCondition.notify_all(); //Workers beyond the count retire
+}
+
+void ThreadPool::work()
+{
+	while(true)
+	{
+		std::function<void()> task;
+		{
+			std::unique_lock lock(tasksMutex);
+			tasksCondition.wait(lock, [this](){ return !tasks.empty() || workerCount > targetWorkerCount; });
+			if(workerCount > targetWorkerCount)
+			{
+				--workerCount;
+				return;
+			}
+			task = std::move(tasks.front().function);
+			tasks.pop_front();
+		}
+		task();
+	}
+}
+
+bool ThreadPool::runPendingTask(const TaskGroup inGroup)
+{
+	std::function<void()> task;
+	{
+		std::lock_guard lock(tasksMutex);
+		const auto groupTask = std::ranges::find(tasks, inGroup, &Task::group);
+		if(groupTask == tasks.end())
+		{
+			return false;
+		}
+		task = std::move(groupTask->function);
+		tasks.erase(groupTask);
+	}
+	task();
+	return true;
+}
@@ -0,0 +1,73 @@
+#include "WeightedSampler.h"
+
+#include <algorithm>
+#include <bit>
+
+WeightedSampler::WeightedSampler(const std::vector<double>& inWeights) : weights(inWeights), partialSums(inWeights.size() + 1, 0.)
+{
+	//Linear construction, each node pushes its sum to its parent once
+	for(size_t index = 1; index < partialSums.size(); ++index)
+	{
+		assert(inWeights[index - 1] >= 0.);
+		partialSums[index] += inWeights[index - 1];
+		if(const auto parentIndex = index + (index & (~index + 1)); parentIndex < partialSums.size())
+		{
+			partialSums[parentIndex] += partialSums[index];
+		}
+	}
+}
+
+size_t WeightedSampler::getSize() const
+{
+	return weights.size();
+}
+
+double WeightedSampler::getTotalWeight() const
+{
+	double totalWeight = 0.;
+	for(auto index = weights.size(); index > 0; index &= index - 1)
+	{
+		totalWeight += partialSums[index];
+	}
+	return totalWeight;
+}
+
+void WeightedSampler::setWeight(const size_t inIndex, const double inWeight)
+{
+	assert(inWeight >= 0.);
+	const auto delta = inWeight - weights[inIndex];
+	weights[inIndex] = inWeight;
+	for(auto index = inIndex + 1; index < partialSums.size(); index += index & (~index + 1))
+	{
+		partialSums[index] += delta;
+	}
+}
+
+size_t WeightedSampler::sample(std::default_random_engine& inRandomEngine) const
+{
+	const auto totalWeight = getTotalWeight();
+	assert(totalWeight > 0.);
+	auto remainingWeight = std::uniform_real_distribution{0., totalWeight}(inRandomEngine);
+
+	//Descends the tree from its highest power of two, skipping the subtrees whose whole weight is below what remains
+	size_t index = 0;
+	for(auto step = std::bit_floor(weights.size()); step; step >>= 1)
+	{
+		if(const auto nextIndex = index + step; nextIndex < partialSums.size() && partialSums[nextIndex] <= remainingWeight)
+		{
+			index = nextIndex;
+			remainingWeight -= partialSums[nextIndex];
+		}
+	}
+
+	//Rounding may land past the last index or on a null weight, the closest index holding weight is taken instead
+	index = std::min(index, weights.size() - 1);
+	for(auto candidateIndex = index + 1; candidateIndex-- > 0;)
+	{
+		if(weights[candidateIndex] > 0.)
+		{
+			return candidateIndex;
+		}
+	}
+	return static_cast<size_t>(std::ranges::find_if(weights, [](const double inWeight){ return inWeight > 0.; }) - weights.begin());
+}
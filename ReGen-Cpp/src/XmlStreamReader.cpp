@@ -0,0 +1,392 @@
+#include "XmlStreamReader.h"
+
+#include <algorithm>
+#include <charconv>
+
+namespace
+{
+	constexpr int END_OF_FILE = std::char_traits<char>::eof();
+
+	bool isWhitespace(const int inCharacter)
+	{
+		return inCharacter == ' ' || inCharacter == '\t' || inCharacter == '\n' || inCharacter == '\r';
+	}
+
+	//Reads the code point of "#digits" or "#xhexdigits"
+	bool parseCharacterReference(const std::string_view inEntity, uint32_t& outCodePoint)
+	{
+		if(inEntity.size() < 2 || inEntity[0] != '#')
+		{
+			return false;
+		}
+		const auto bIsHexadecimal = inEntity[1] == 'x';
+		const auto* entityEnd = inEntity.data() + inEntity.size();
+		const auto [end, error] = std::from_chars(inEntity.data() + (bIsHexadecimal ? 2 : 1), entityEnd, outCodePoint, bIsHexadecimal ? 16 : 10);
+		return error == std::errc() && end == entityEnd;
+	}
+
+	void appendUtf8(const uint32_t inCodePoint, std::string& ioValue)
+	{
+		if(inCodePoint < 0x80)
+		{
+			ioValue.push_back(static_cast<char>(inCodePoint));
+		}
+		else if(inCodePoint < 0x800)
+		{
+			ioValue.push_back(static_cast<char>(0xC0 | inCodePoint >> 6));
+			ioValue.push_back(static_cast<char>(0x80 | (inCodePoint & 0x3F)));
+		}
+		else if(inCodePoint < 0x10000)
+		{
+			ioValue.push_back(static_cast<char>(0xE0 | inCodePoint >> 12));
+			ioValue.push_back(static_cast<char>(0x80 | (inCodePoint >> 6 & 0x3F)));
+			ioValue.push_back(static_cast<char>(0x80 | (inCodePoint & 0x3F)));
+		}
+		else
+		{
+			ioValue.push_back(static_cast<char>(0xF0 | inCodePoint >> 18));
+			ioValue.push_back(static_cast<char>(0x80 | (inCodePoint >> 12 & 0x3F)));
+			ioValue.push_back(static_cast<char>(0x80 | (inCodePoint >> 6 & 0x3F)));
+			ioValue.push_back(static_cast<char>(0x80 | (inCodePoint & 0x3F)));
+		}
+	}
+}
+
+XmlStreamReader::XmlStreamReader(const std::string& inPath) : file(inPath, std::ios::in | std::ios::binary), buffer(file.rdbuf()), attributeCount(0), bIsSelfClosing(false), bHasRootElement(false), line(1)
+{
+}
+
+bool XmlStreamReader::isOpen() const
+{
+	return file.is_open();
+}
+
+XmlStreamReader::Event XmlStreamReader::next()
+{
+	if(!error.empty())
+	{
+		return Event::Error;
+	}
+
+	if(bIsSelfClosing)
+	{
+		bIsSelfClosing = false;
+		openElements.pop_back();
+		return Event::EndElement;
+	}
+
+	while(true)
+	{
+		if(peek() == END_OF_FILE)
+		{
+			if(!openElements.empty())
+			{
+				return fail("end of file before </" + openElements.back() + ">");
+			}
+			if(!bHasRootElement)
+			{
+				return fail("no root element");
+			}
+			return Event::EndOfDocument;
+		}
+
+		if(peek() != '<')
+		{
+			if(!readValue('<', false, text))
+			{
+				return fail("malformed entity");
+			}
+			if(!std::all_of(text.begin(), text.end(), isWhitespace))
+			{
+				return Event::Text;
+			}
+			continue;
+		}
+		get();
+
+		if(peek() == '/')
+		{
+			get();
+			readName(name);
+			if(openElements.empty() || openElements.back() != name)
+			{
+				return fail("</" + name + "> doesn't close " + (openElements.empty() ? "any element" : "<" + openElements.back() + ">"));
+			}
+			skipWhitespaces();
+			if(get() != '>')
+			{
+				return fail("unterminated </" + name + ">");
+			}
+			openElements.pop_back();
+			return Event::EndElement;
+		}
+
+		if(peek() == '?')
+		{
+			if(!skipPast("?>"))
+			{
+				return fail("unterminated processing instruction");
+			}
+			continue;
+		}
+
+		if(peek() == '!')
+		{
+			get();
+			if(peek() == '-')
+			{
+				if(!skipPast("-->"))
+				{
+					return fail("unterminated comment");
+				}
+			}
+			else if(peek() == '[') //CDATA section, read as is
+			{
+				text.clear();
+				if(!skipPast("[CDATA[") || !skipPast("]]>", &text))
+				{
+					return fail("unterminated CDATA section");
+				}
+				text.resize(text.size() - 3);
+				if(!text.empty())
+				{
+					return Event::Text;
+				}
+			}
+			else //Doctype, its internal subset holds no element
+			{
+				int depth = 0;
+				auto character = get();
+				for(; character != END_OF_FILE && (character != '>' || depth > 0); character = get())
+				{
+					depth += character == '[' ? 1 : character == ']' ? -1 : 0;
+				}
+				if(character == END_OF_FILE)
+				{
+					return fail("unterminated doctype");
+				}
+			}
+			continue;
+		}
+
+		readName(name);
+		if(name.empty())
+		{
+			return fail("element without a name");
+		}
+		attributeCount = 0;
+		while(true)
+		{
+			skipWhitespaces();
+			if(const auto character = peek(); character == END_OF_FILE)
+			{
+				return fail("end of file inside <" + name + ">");
+			}
+			else if(character == '>' || character == '/')
+			{
+				get();
+				if(character == '/' && get() != '>')
+				{
+					return fail("unterminated <" + name + "/>");
+				}
+				bIsSelfClosing = character == '/';
+				bHasRootElement = true;
+				openElements.emplace_back(name);
+				return Event::StartElement;
+			}
+
+			if(attributeCount == attributes.size())
+			{
+				attributes.emplace_back();
+			}
+			auto& [attributeName, attributeValue] = attributes[attributeCount++];
+			readName(attributeName);
+			if(attributeName.empty())
+			{
+				return fail("unexpected character in <" + name + ">");
+			}
+			skipWhitespaces();
+			if(get() != '=')
+			{
+				return fail("attribute " + attributeName + " of <" + name + "> has no value");
+			}
+			skipWhitespaces();
+			if(const auto quote = get(); quote != '"' && quote != '\'')
+			{
+				return fail("attribute " + attributeName + " of <" + name + "> isn't quoted");
+			}
+			else if(!readValue(quote, true, attributeValue) || get() != quote)
+			{
+				return fail("attribute " + attributeName + " of <" + name + "> is malformed");
+			}
+		}
+	}
+}
+
+const std::string& XmlStreamReader::getName() const
+{
+	return name;
+}
+
+const std::string& XmlStreamReader::getText() const
+{
+	return text;
+}
+
+size_t XmlStreamReader::getAttributeCount() const
+{
+	return attributeCount;
+}
+
+const std::pair<std::string, std::string>& XmlStreamReader::getAttribute(const size_t inPosition) const
+{
+	assert(inPosition < attributeCount);
+	return attributes[inPosition];
+}
+
+std::string_view XmlStreamReader::getAttribute(const std::string_view inName) const
+{
+	for(size_t attributePosition = 0; attributePosition < attributeCount; ++attributePosition)
+	{
+		if(attributes[attributePosition].first == inName)
+		{
+			return attributes[attributePosition].second;
+		}
+	}
+	return {};
+}
+
+const std::string& XmlStreamReader::getError() const
+{
+	return error;
+}
+
+int XmlStreamReader::peek()
+{
+	return buffer->sgetc();
+}
+
+int XmlStreamReader::get()
+{
+	const auto character = buffer->sbumpc();
+	line += character == '\n' ? 1 : 0;
+	return character;
+}
+
+void XmlStreamReader::skipWhitespaces()
+{
+	while(isWhitespace(peek()))
+	{
+		get();
+	}
+}
+
+void XmlStreamReader::readName(std::string& outName)
+{
+	outName.clear();
+	for(auto character = peek(); character != END_OF_FILE && !isWhitespace(character) && character != '/' && character != '>' && character != '='; character = peek())
+	{
+		outName.push_back(static_cast<char>(get()));
+	}
+}
+
+bool XmlStreamReader::readValue(const int inDelimiter, const bool bInNormalizeWhitespaces, std::string& outValue)
+{
+	outValue.clear();
+	for(auto character = peek(); character != END_OF_FILE && character != inDelimiter; character = peek())
+	{
+		get();
+		if(character == '&')
+		{
+			if(!readEntity(outValue))
+			{
+				return false;
+			}
+			continue;
+		}
+		if(character == '\r') //Line ends are normalized to \n
+		{
+			if(peek() == '\n')
+			{
+				get();
+			}
+			character = '\n';
+		}
+		outValue.push_back(static_cast<char>(bInNormalizeWhitespaces && isWhitespace(character) ? ' ' : character));
+	}
+	return true; //The delimiter is left to the caller, markup starts the next event and quotes are checked by the element
+}
+
+bool XmlStreamReader::skipPast(const std::string_view inTerminator, std::string* outSkipped)
+{
+	std::string window;
+	for(auto character = get(); character != END_OF_FILE; character = get())
+	{
+		window.push_back(static_cast<char>(character));
+		if(outSkipped)
+		{
+			outSkipped->push_back(static_cast<char>(character));
+		}
+		if(window.ends_with(inTerminator))
+		{
+			return true;
+		}
+		if(window.size() > inTerminator.size())
+		{
+			window.erase(window.begin());
+		}
+	}
+	return false;
+}
+
+bool XmlStreamReader::readEntity(std::string& ioValue)
+{
+	//Entities longer than any known one can't be valid
+	constexpr size_t MAX_ENTITY_SIZE = 10;
+	std::string entity;
+	while(entity.size() < MAX_ENTITY_SIZE && peek() != END_OF_FILE && peek() != ';' && peek() != '<' && !isWhitespace(peek()))
+	{
+		entity.push_back(static_cast<char>(get()));
+	}
+	if(peek() != ';')
+	{
+		return false;
+	}
+	get();
+
+	if(entity == "lt")
+	{
+		ioValue.push_back('<');
+	}
+	else if(entity == "gt")
+	{
+		ioValue.push_back('>');
+	}
+	else if(entity == "amp")
+	{
+		ioValue.push_back('&');
+	}
+	else if(entity == "quot")
+	{
+		ioValue.push_back('"');
+	}
+	else if(entity == "apos")
+	{
+		ioValue.push_back('\'');
+	}
+	else if(uint32_t codePoint; parseCharacterReference(entity, codePoint) && codePoint > 0 && codePoint <= 0x10FFFF)
+	{
+		appendUtf8(codePoint, ioValue);
+	}
+	else
+	{
+		return false;
+	}
+	return true;
+}
+
+XmlStreamReader::Event XmlStreamReader::fail(const std::string_view inMessage)
+{
+	error = "line " + std::to_string(line) + ": " + std::string(inMessage);
+	return Event::Error;
+}
@@ -1,17 +1,49 @@
+#include <chrono>
+#include <cstdlib>
+#include <thread>
+
 #include "CommandsDeclaration.h"
 #include "DataManager.h"
+#include "OutputPipeline.h"
 #include "Scheduler.h"
+#include "ThreadPool.h"
+
+namespace
+{
+	constexpr auto SOURCES_POLLING_PERIOD = std::chrono::seconds(1);
+
+	//Polls the sources until some of them changed and were loaded again. Only called between batches, stories read the data in place
+	bool waitForReload()
+	{
+		while(!DataManager::getInstance()->reload())
+		{
+			std::this_thread::sleep_for(SOURCES_POLLING_PERIOD);
+		}
+		return true;
+	}
+}
 
 int main()
 {
-	DataManager::getInstance()->init("one_story");
-	declareCommands();
+	declareCommands(); //Rules compile their commands when they are loaded
+	if(!DataManager::getInstance()->init("one_story"))
+	{
+		return EXIT_FAILURE;
+	}
+	DataManager::getInstance()->loadMatchCache();
 
-	for(int i = 0; i < DataManager::getInstance()->getTestLayout().numStoryToGenerate; ++i)
+	//The layout is read again on each reload, a batch is generated with its settings of the time
+	const auto& testLayout = DataManager::getInstance()->getTestLayout();
+	do
 	{
-		Scheduler scheduler("narrative" + std::to_string(i));
-		scheduler.run();
+		OutputPipeline::getInstance()->setRenderImages(testLayout.bRenderImages);
+		ThreadPool::getInstance()->setThreadCount(testLayout.threadCount);
+		Scheduler::runBatch("narrative", testLayout.numStoryToGenerate, testLayout.seed);
+
+		DataManager::getInstance()->saveMatchCache();
+		OutputPipeline::getInstance()->flush(); //Written stories hold conditions pointing into the data a reload replaces
 	}
+	while(testLayout.bWatchSources && waitForReload());
 
 	return 0;
 }